@@ -0,0 +1,393 @@
+//============================================================================
+// Name        : booth_sim.cpp
+// Author      : Devang Khamar
+// Version     : 1.x
+// Copyright   : N/A
+// Description : Exhaustive, bit-sliced reference simulator of the booth
+//				 multiplier of booth_8.sv / booth_16.sv
+//============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+
+#define LANE_WORDS 4						//64-bit words per slice, i.e. 64*LANE_WORDS operand pairs per step
+#define LANES (64*LANE_WORDS)
+#define CHUNK (1ULL << 20)					//operand pairs handed to a thread at a time
+#define MAX_WIDTH 16
+
+struct slice{
+	/*
+	 * One bit of a signal for LANES operand pairs at once: bit j of w[k] is the value
+	 * of the signal in lane 64*k+j. Every gate of the datapath becomes a handful of
+	 * word operations that the compiler can vectorize.
+	 */
+	unsigned long long w[LANE_WORDS];
+
+	static slice all(bool b){
+		slice s;
+		for(int k = 0; k < LANE_WORDS; k++){
+			s.w[k] = b ? ~0ULL : 0ULL;
+		}
+		return s;
+	}
+	slice operator&(const slice &o) const { slice s; for(int k = 0; k < LANE_WORDS; k++) s.w[k] = w[k] & o.w[k]; return s; }
+	slice operator|(const slice &o) const { slice s; for(int k = 0; k < LANE_WORDS; k++) s.w[k] = w[k] | o.w[k]; return s; }
+	slice operator^(const slice &o) const { slice s; for(int k = 0; k < LANE_WORDS; k++) s.w[k] = w[k] ^ o.w[k]; return s; }
+	slice operator~() const { slice s; for(int k = 0; k < LANE_WORDS; k++) s.w[k] = ~w[k]; return s; }
+};
+
+slice mux(const slice &sel, const slice &a, const slice &b){
+	// sel ? a : b
+	return (sel & a) | (~sel & b);
+}
+
+void transpose64(unsigned long long m[64]){
+	/*
+	 * Transposes a 64x64 bit matrix in place (row i, bit j <-> row j, bit i) by
+	 * swapping blocks of halving size.
+	 */
+	unsigned long long mask = 0x00000000FFFFFFFFULL, t;
+	for(int j = 32; j != 0; j >>= 1, mask ^= (mask << j)){
+		for(int k = 0; k < 64; k = ((k | j) + 1) & ~j){
+			t = ((m[k] >> j) ^ m[k | j]) & mask;
+			m[k] ^= (t << j);
+			m[k | j] ^= t;
+		}
+	}
+}
+
+struct laneState{
+	// registers of the booth module in one lane, bit k of a vector in bit k
+	unsigned curr_state, counter;
+	bool stat_reg, init_reg;
+	unsigned long long mplr, mpld, product_reg;
+};
+
+class boothSim{
+	/*
+	 * Cycle-accurate model of the booth module (FSM with datapath, recodeLogic and
+	 * add_subtract) for operands of width bits. The control part (curr_state, counter,
+	 * stat_reg) does not depend on the operands, so it is simulated once for all
+	 * lanes; every register of the datapath is an array of slices, one per bit.
+	 */
+	enum state {START, ADD, SHIFT, FINISH};
+
+	unsigned width, pw;						// operand width, width of product_reg (2*width+2)
+	slice mplr[MAX_WIDTH], mpld[MAX_WIDTH];
+	slice product_reg[2*MAX_WIDTH + 2];
+	slice init_reg;
+	unsigned curr_state, counter;
+	bool stat_reg;
+
+	void addSubtract(slice *result, const slice *op_1, const slice *op_2, const slice &add_sub){
+		/*
+		 * add_subtract: result = add_sub ? op_1 - op_2 : op_1 + op_2, on width+2 bits.
+		 * The subtraction adds ~op_2 with a carry in of 1.
+		 */
+		slice carry = add_sub, b, t;
+		for(unsigned i = 0; i < width + 2; i++){
+			b = op_2[i] ^ add_sub;
+			t = op_1[i] ^ b;
+			result[i] = t ^ carry;
+			carry = (op_1[i] & b) | (t & carry);
+		}
+	}
+
+public:
+	unsigned long long cycles;				// clock cycles simulated (each covers LANES products)
+
+	void cycle(bool reset, bool start_pulse, const slice *multiplier, const slice *multiplicand){
+		/*
+		 * One clock edge: computes the always@* block from the current registers and
+		 * latches the next values (always@(posedge clk, posedge reset)).
+		 */
+		slice m1[MAX_WIDTH], m2[MAX_WIDTH], prod[2*MAX_WIDTH + 2], ireg = init_reg;
+		unsigned next_state = curr_state, nxt_cnt = counter;
+		bool status = stat_reg;
+		unsigned i;
+
+		memcpy(m1, mplr, sizeof(mplr));
+		memcpy(m2, mpld, sizeof(mpld));
+		memcpy(prod, product_reg, sizeof(product_reg));
+
+		switch(curr_state){
+			case START:
+				if(start_pulse){
+					for(i = 0; i < width; i++){
+						m1[i] = multiplier[i];
+						m2[i] = multiplicand[i];
+					}
+					status = true;
+					for(i = 0; i < pw; i++){
+						prod[i] = slice::all(false);
+					}
+					next_state = ADD;
+					ireg = slice::all(false);
+				}
+				break;
+			case ADD:{
+				// recodeLogic on window = {mplr[1:0], init_reg}
+				slice w2 = mplr[1], w1 = mplr[0], w0 = init_reg;
+				slice add_sub = w2;
+				slice skip = (w2 & w1 & w0) | ~(w2 | w1 | w0);
+				slice dbl = (~w2 & w1 & w0) | (w2 & ~w1 & ~w0);
+				slice op_2[MAX_WIDTH + 2], op[MAX_WIDTH + 2];
+
+				// op_2 = double ? {mpld[w-1], mpld, 1'b0} : {mpld[w-1], mpld[w-1], mpld}
+				op_2[0] = ~dbl & mpld[0];
+				for(i = 1; i < width; i++){
+					op_2[i] = mux(dbl, mpld[i-1], mpld[i]);
+				}
+				op_2[width] = op_2[width+1] = mpld[width-1];
+				addSubtract(op, product_reg + width, op_2, add_sub);
+				for(i = 0; i < width + 2; i++){
+					prod[width + i] = mux(skip, product_reg[width + i], op[i]);
+				}
+				next_state = SHIFT;
+				break;
+			}
+			case SHIFT:
+				next_state = (counter == 0) ? FINISH : ADD;
+				for(i = 0; i < pw; i++){
+					prod[i] = product_reg[std::min(i + 2, pw - 1)];
+				}
+				for(i = 0; i < width; i++){
+					m1[i] = mplr[std::min(i + 2, width - 1)];
+				}
+				ireg = mplr[1];
+				nxt_cnt = (counter - 1) & 7;
+				break;
+			case FINISH:
+				status = false;
+				nxt_cnt = width/2 - 1;
+				next_state = START;
+				for(i = 0; i < width; i++){
+					m1[i] = m2[i] = slice::all(false);
+				}
+				break;
+		}
+
+		if(reset){
+			curr_state = START;
+			counter = width/2 - 1;
+			stat_reg = false;
+			init_reg = slice::all(false);
+			for(i = 0; i < width; i++){
+				mplr[i] = mpld[i] = slice::all(false);
+			}
+			for(i = 0; i < pw; i++){
+				product_reg[i] = slice::all(false);
+			}
+			return;
+		}
+		curr_state = next_state;
+		counter = nxt_cnt;
+		stat_reg = status;
+		init_reg = ireg;
+		memcpy(mplr, m1, sizeof(mplr));
+		memcpy(mpld, m2, sizeof(mpld));
+		memcpy(product_reg, prod, sizeof(product_reg));
+	}
+
+	boothSim(unsigned w){
+		width = w;
+		pw = 2*w + 2;
+		cycles = 0;
+		cycle(true, false, NULL, NULL);
+	}
+
+	void multiply(const slice *multiplier, const slice *multiplicand, slice *product){
+		/*
+		 * Runs one multiplication from the start state: a start pulse, then the
+		 * add/shift cycles until the finish state, where product = product_reg[2w-1:0]
+		 * is read. The FSM then returns to the start state by itself.
+		 */
+		cycle(false, true, multiplier, multiplicand);
+		cycles++;
+		while(curr_state != FINISH){
+			cycle(false, false, NULL, NULL);
+			cycles++;
+		}
+		for(unsigned i = 0; i < 2*width; i++){
+			product[i] = product_reg[i];
+		}
+		cycle(false, false, NULL, NULL);
+		cycles++;
+	}
+
+	laneState lane(unsigned j){
+		/*
+		 * The registers of lane j, e.g. to compare the visited states with the
+		 * reachable states computed by ROBDDs reach.
+		 */
+		laneState s = {curr_state, counter, stat_reg, ((init_reg.w[j/64] >> (j%64)) & 1) != 0, 0, 0, 0};
+		for(unsigned i = 0; i < width; i++){
+			s.mplr |= ((mplr[i].w[j/64] >> (j%64)) & 1) << i;
+			s.mpld |= ((mpld[i].w[j/64] >> (j%64)) & 1) << i;
+		}
+		for(unsigned i = 0; i < pw && i < 64; i++){
+			s.product_reg |= ((product_reg[i].w[j/64] >> (j%64)) & 1) << i;
+		}
+		return s;
+	}
+};
+
+struct checkResult{
+	unsigned long long pairs, mismatches, cycles;
+	unsigned long long firstBad;			// smallest failing pair index, ~0 if none
+	unsigned long long got, expected;		// product of firstBad
+};
+
+class exhaustiveCheck{
+	/*
+	 * Checks every pair of signed operands of width bits against the native multiply.
+	 * Pair p holds the multiplier in its low width bits and the multiplicand in the
+	 * high ones. Pairs are processed in chunks taken by the threads from a shared
+	 * counter; within a step, lane j handles pair base+j, so the low bits of the
+	 * operands follow fixed patterns and the others are constant across lanes.
+	 */
+	unsigned width;
+	unsigned long long total;
+	std::atomic<unsigned long long> next;
+	std::mutex lock;
+	checkResult res;
+
+	static slice pairBit(unsigned long long base, unsigned k){
+		// slice of bit k of the pair index base+j over the lanes j
+		slice s;
+		for(int q = 0; q < LANE_WORDS; q++){
+			unsigned long long v = 0;
+			if(k < 6){
+				for(unsigned j = 0; j < 64; j++){
+					v |= (unsigned long long)((j >> k) & 1) << j;
+				}
+			}
+			else{
+				v = (((base + 64ULL*q) >> k) & 1) ? ~0ULL : 0ULL;
+			}
+			s.w[q] = v;
+		}
+		return s;
+	}
+
+	void worker(){
+		boothSim sim(width);
+		slice a[MAX_WIDTH], b[MAX_WIDTH], product[2*MAX_WIDTH];
+		unsigned long long rows[64], mask = (width*2 == 64) ? ~0ULL : ((1ULL << (2*width)) - 1);
+		checkResult mine = {0, 0, 0, ~0ULL, 0, 0};
+		unsigned long long start, end, base;
+
+		while((start = next.fetch_add(CHUNK)) < total){
+			end = std::min(start + CHUNK, total);
+			for(base = start; base < end; base += LANES){
+				for(unsigned i = 0; i < width; i++){
+					a[i] = pairBit(base, i);
+					b[i] = pairBit(base, width + i);
+				}
+				sim.multiply(a, b, product);
+				for(int q = 0; q < LANE_WORDS; q++){
+					// un-slice the products of the 64 lanes of word q
+					for(unsigned i = 0; i < 64; i++){
+						rows[i] = (i < 2*width) ? product[i].w[q] : 0;
+					}
+					transpose64(rows);
+					for(unsigned j = 0; j < 64 && base + 64*q + j < end; j++){
+						unsigned long long p = base + 64*q + j;
+						long long ma = (long long)(p << (64 - width)) >> (64 - width);
+						long long mb = (long long)((p >> width) << (64 - width)) >> (64 - width);
+						unsigned long long expected = (unsigned long long)(ma * mb) & mask;
+						mine.pairs++;
+						if(rows[j] != expected){
+							mine.mismatches++;
+							if(p < mine.firstBad){
+								mine.firstBad = p;
+								mine.got = rows[j];
+								mine.expected = expected;
+							}
+						}
+					}
+				}
+			}
+		}
+		mine.cycles = sim.cycles;
+		std::lock_guard<std::mutex> guard(lock);
+		res.pairs += mine.pairs;
+		res.mismatches += mine.mismatches;
+		res.cycles += mine.cycles;
+		if(mine.firstBad < res.firstBad){
+			res.firstBad = mine.firstBad;
+			res.got = mine.got;
+			res.expected = mine.expected;
+		}
+	}
+
+public:
+	checkResult run(unsigned w, unsigned threads, unsigned long long pairs){
+		/*
+		 * Checks the first pairs operand pairs (all 2^(2w) if 0) on the given
+		 * number of threads.
+		 */
+		std::vector<std::thread> pool;
+		width = w;
+		total = (pairs == 0 || pairs > (1ULL << (2*w))) ? (1ULL << (2*w)) : pairs;
+		next = 0;
+		res = {0, 0, 0, ~0ULL, 0, 0};
+		for(unsigned t = 0; t < threads; t++){
+			pool.push_back(std::thread(&exhaustiveCheck::worker, this));
+		}
+		for(unsigned t = 0; t < threads; t++){
+			pool[t].join();
+		}
+		return res;
+	}
+};
+
+// ROBDDs.cpp includes this file without main to cross-check its reachable states
+#ifndef BOOTH_SIM_NO_MAIN
+int main(int argc, char **argv){
+	/*
+	 * Usage: booth_sim [width] [threads] [pairs]
+	 * width is 8 (booth_8.sv, default) or 16 (booth_16.sv), any even width up to 16
+	 * works. threads defaults to the number of hardware threads, pairs to all 2^(2*width)
+	 * operand pairs. Returns 0 if every product matches.
+	 */
+	typedef std::chrono::steady_clock clk;
+	unsigned width = argc > 1 ? atoi(argv[1]) : 8;
+	unsigned threads = argc > 2 ? atoi(argv[2]) : 0;
+	unsigned long long pairs = argc > 3 ? strtoull(argv[3], NULL, 10) : 0;
+	exhaustiveCheck check;
+
+	if(width < 4 || width > MAX_WIDTH || width % 2 != 0){
+		printf("Width must be even and between 4 and %d\n", MAX_WIDTH);
+		return 2;
+	}
+	if(threads == 0){
+		threads = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+	clk::time_point t0 = clk::now();
+	checkResult r = check.run(width, threads, pairs);
+	double seconds = std::chrono::duration<double>(clk::now() - t0).count();
+
+	printf("booth (%u-bit): %llu operand pairs on %u threads, %d lanes per step\n",
+			width, r.pairs, threads, LANES);
+	printf("%llu clock cycles simulated (%d lanes each), %.3fs, %.3e products/second\n",
+			r.cycles, LANES, seconds, r.pairs / seconds);
+	if(r.mismatches == 0){
+		printf("PASSED: every product matches the native multiply\n");
+		return 0;
+	}
+	printf("FAILED: %llu mismatches, first one multiplier = %lld, multiplicand = %lld: product %llu, expected %llu\n",
+			r.mismatches,
+			(long long)(r.firstBad << (64 - width)) >> (64 - width),
+			(long long)((r.firstBad >> width) << (64 - width)) >> (64 - width),
+			r.got, r.expected);
+	return 1;
+}
+#endif
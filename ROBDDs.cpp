@@ -12,10 +12,38 @@
 #include <string.h>
 #include <stdio.h>
 #include <vector>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <unordered_map>
+#include <string>
 #include <stdbool.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <ctype.h>
+#include <errno.h>
+#define BOOTH_SIM_NO_MAIN
+#include "Lab3/booth_sim.cpp"				//cycle-accurate booth model, to cross-check reach
 
 #define MAX_PROP_LENGTH 10						//maximum readable length of variable string
 #define MAX_LINE_SIZE  1000						//maximum length of Input Boolean expression
+#define MAX_VARS 300							//size of the variable arrays held by the parser
+
+#define BDD_FALSE 0								//terminal nodes of a shared manager
+#define BDD_TRUE  1
+#define BDD_ABORTED 0xFFFFFFFFu					//result of a manager operation stopped by a resource limit
+#define BDD_FREE_LEVEL 0xFFFFFFFFu				//level of a node of a shared manager freed by gc()
+#define CACHE_SIZE (1 << 16)					//entries in the computed table of a shared manager (power of 2)
+#define SIM_WORDS  64							//64-bit words of random patterns simulated before building BDDs
+#define CACHE_MAX_MB 256						//default size cap of the persistent ROBDD cache (see bddDiskCache)
 
 #define BIG_TEST_STRING  "(IMPL (AND (OR (IMPL x1 (NOT x2)) (EQUIV (IMPL x3 x4) (AND x5 x6))) (AND (EQUIV (NOT x7) x8) (IMPL (EQUIV x9 x10) (OR x12 x13)))) (AND (OR (IMPL x14 (NOT x15)) (EQUIV (IMPL x16 x17) (AND x18 x19))) (AND (EQUIV (NOT x20) x21) (IMPL (EQUIV x22 x23) (OR x24 x25)))))";
 const char *STRING_NOT   = "NOT";
@@ -28,10 +56,10 @@ const bool TRUE  = true;
 
 //Symbol Table is useful for debugging purposes
 
-//const char* symbolTable[] ={"NOT", "AND", "OR", "IMPL", "EQUIV", "T", "F", "var","root", "invalid"};
-
+//const char* symbolTable[] ={"NOT", "AND", "OR", "IMPL", "EQUIV", "XOR", "T", "F", "var","root", "invalid"};
 
-enum oprtr {NOT, AND, OR, IMPL, EQUIV, T, F, var,root, invalid};
+// XOR is not part of the grammar, it is only used internally by the shared manager (bddManager)
+enum oprtr {NOT, AND, OR, IMPL, EQUIV, XOR, T, F, var,root, invalid};
 
 class abSyntaxTree{
 	/*
@@ -71,6 +99,18 @@ class abSyntaxTree{
 
 };
 
+void freeTree(abSyntaxTree *node){
+	/*
+	 * Deletes a whole tree made by the parser (~abSyntaxTree() only deletes the node).
+	 */
+	if(node == NULL){
+		return;
+	}
+	freeTree(node->lptr);
+	freeTree(node->rptr);
+	delete node;
+}
+
 struct Token{
 	/*
 	 * Useful encapsulation to pass data and type to multiple functions.
@@ -411,8 +451,8 @@ class parser{
 
 public:
 
-	bool variables[300] = {false};
-	unsigned var_list[300] ={0};
+	bool variables[MAX_VARS] = {false};
+	unsigned var_list[MAX_VARS] ={0};
 	int numVar = 0;
 
 	abSyntaxTree* formulaWrapper(char *s) {
@@ -519,6 +559,42 @@ void evaluate(abSyntaxTree* node){
    }
 }
 
+struct alignas(16) bddNode{
+	/*
+	 * A node of an ROBDD packed into 16 bytes, so four nodes share a 64-byte cache
+	 * line. The node number is the position of the node in its table, so it is
+	 * not stored.
+	 */
+	unsigned level;		// var(u): variable index (ROBDD) or level in the variable order (bddManager)
+	unsigned low;		// low(u)
+	unsigned high;		// high(u)
+	unsigned next;		// next node in the same bucket of the unique table
+};
+
+enum bddStatus {BDD_OK, BDD_NODE_LIMIT, BDD_MEMORY_LIMIT, BDD_TIME_LIMIT, BDD_CANCELLED};
+
+struct bddLimits{
+	/*
+	 * Resource limits of a shared manager, 0 meaning no limit. As global limits they
+	 * bound the live nodes, the bytes held by the tables and the time since the
+	 * limits were set. As per operation limits they bound the nodes created, the bytes
+	 * added and the time spent by a single call.
+	 */
+	unsigned long long maxNodes;
+	unsigned long long maxBytes;
+	double maxSeconds;
+};
+
+const char* statusName(bddStatus status){
+	switch(status){
+		case BDD_NODE_LIMIT:   return "node limit reached";
+		case BDD_MEMORY_LIMIT: return "memory limit reached";
+		case BDD_TIME_LIMIT:   return "time limit reached";
+		case BDD_CANCELLED:    return "cancelled";
+		default:               return "ok";
+	}
+}
+
 class ROBDD{
 
 	/*
@@ -530,9 +606,10 @@ class ROBDD{
 	 * and G. The sizes assigned are assumed to be reasonable enough to represent
 	 * boolean expressions with a large number of variables.
 	 *
+	 * Entries of T are packed bddNodes. The node number u is the index of the entry,
+	 * and entries that hash to the same slot of H are chained through their next field.
+	 *
 	 */
-	enum tableT {varnum,var_index,low_node,high_node};
-	enum tableHG {membership,varid};
 
 	unsigned numVars;
 	unsigned index_u;
@@ -560,8 +637,8 @@ class ROBDD{
 		return (pair(i,pair(j,k)) % 523);
 	}
 public:
-	unsigned T[523][4];		 // stores adjacency list of the ROBDD
-	unsigned H[523][2]= {{0}}; // used for fast lookup of existing entries
+	bddNode T[523];			 // stores adjacency list of the ROBDD
+	unsigned H[523]= {0};	 // first node of each hash chain (0 => empty), used for fast lookup of existing entries
 	unsigned G[523][2]= {{0}}; // used for Apply()
 
 	//used to keep track of number entries in table T.
@@ -583,10 +660,10 @@ public:
 		 * initializes variable number index (index_u), associates root node of abstract syntax tree
 		 * with local node variable and reserves space needed for finding satisfiability inputs.
 		 */
-		T[1][varnum] = 1; T[0][varnum] = 0;
-		T[1][var_index] = T[0][var_index] =  max_size+1;
-		T[1][low_node] = 1; T[0][low_node] = 0;
-		T[1][high_node] = 1; T[0][high_node] = 0;
+		T[1].level = T[0].level =  max_size+1;
+		T[1].low = 1; T[0].low = 0;
+		T[1].high = 1; T[0].high = 0;
+		T[1].next = T[0].next = 0;
 		numVars = max_size;
 		variables = varptr;
 		var_list = var_listptr;
@@ -602,19 +679,21 @@ public:
 		 * by looking it up in Table H. If found it returns
 		 * the index of the entry.
 		 */
-		unsigned int key =  hash(i,l,h);
-		if(H[key][tableHG::membership] == 1){
-			return true;
-		}
-	return false;
+		return (lookup(i,l,h) != 0);
 	}
 
 	unsigned lookup(unsigned i, unsigned l, unsigned h ){
 		/*
-		 * lookup function to find index of queried entry
+		 * lookup function to find index of queried entry. Returns 0
+		 * if the entry is not in T.
 		 */
 		unsigned int key =  hash(i,l,h);
-		return (H[key][tableHG::varid]);
+		for(unsigned u = H[key]; u != 0; u = T[u].next){
+			if(T[u].level == i && T[u].low == l && T[u].high == h){
+				return u;
+			}
+		}
+		return 0;
 	}
 
 	void insertInH(unsigned i, unsigned l, unsigned h, unsigned u){
@@ -623,19 +702,24 @@ public:
 		 * redundant entries.
 		 */
 			unsigned int key = hash(i,l,h);
-			H[key][tableHG::membership] = 1;
-			H[key][tableHG::varid]     = u;
+			T[u].next = H[key];
+			H[key] = u;
 		}
 
 	unsigned addToT(unsigned i, unsigned l, unsigned h){
 		/*
 		 * Adds an entry with given arguments to the Table T.
 		 */
+		if(index_u >= 523){
+			// T is fixed size, stop instead of writing past it
+			printf("\nROBDD too large: more than 523 nodes, use the equivalence check instead");
+			fflush(stdout);
+			exit(1);
+		}
 		unsigned u = index_u++;
-		T[u][tableT::varnum]    = u;
-		T[u][tableT::var_index] = i;
-		T[u][tableT::low_node]  = l;
-		T[u][tableT::high_node] = h;
+		T[u].level = i;
+		T[u].low  = l;
+		T[u].high = h;
 		return u;
 	}
 
@@ -704,8 +788,8 @@ public:
 		 *
 		 * I do not want infinite loops here.
 		 */
-		r1->T[0][var_index]=r1->T[1][var_index]= numVars + r1->numVars;
-		T[0][var_index] = T[1][var_index] = numVars + r1->numVars;
+		r1->T[0].level=r1->T[1].level= numVars + r1->numVars;
+		T[0].level = T[1].level = numVars + r1->numVars;
 		unsigned u1, u2;
 		u1 = r1->numVars;
 		u2 = numVars;
@@ -721,21 +805,20 @@ public:
 		if(G[ind][0] != 0){
 			return G[ind][1];
 		}
-		else if ((R1->T[u1][varnum] == 0 || R1->T[u1][varnum] == 1) &&
-				(T[u2][varnum] == 0 || T[u2][varnum] == 1)){
-			u = operate(op, R1->T[u1][varnum], T[u2][varnum]);
+		else if (u1 <= 1 && u2 <= 1){
+			u = operate(op, u1, u2);
 		}
-		else if(R1->T[u1][var_index] == T[u2][var_index]){
-			u = Mk(R1->T[u1][var_index],Apply_(R1->T[u1][low_node],T[u2][low_node],op, R1),
-					Apply_(R1->T[u1][high_node],T[u2][high_node],op,R1));
+		else if(R1->T[u1].level == T[u2].level){
+			u = Mk(R1->T[u1].level,Apply_(R1->T[u1].low,T[u2].low,op, R1),
+					Apply_(R1->T[u1].high,T[u2].high,op,R1));
 		}
-		else if(T[u2][var_index] > R1->T[u1][var_index] ){
-			u = Mk(R1->T[u1][var_index],Apply_(R1->T[u1][low_node],T[u2][var_index],op,R1),
-								Apply_(R1->T[u1][high_node],T[u2][var_index],op,R1));
+		else if(T[u2].level > R1->T[u1].level ){
+			u = Mk(R1->T[u1].level,Apply_(R1->T[u1].low,T[u2].level,op,R1),
+								Apply_(R1->T[u1].high,T[u2].level,op,R1));
 		}
-		else /*R1->[u1][var_index] > T[u2][var_index]*/{
-			u = Mk(T[u2][var_index],Apply_(R1->T[u1][var_index],T[u2][low_node],op, R1),
-								Apply_(R1->T[u1][var_index],T[u2][high_node],op,R1));
+		else /*R1->[u1][var_index] > T[u2].level*/{
+			u = Mk(T[u2].level,Apply_(R1->T[u1].level,T[u2].low,op, R1),
+								Apply_(R1->T[u1].level,T[u2].high,op,R1));
 		}
 		G[ind][0] = 1; G[ind][1] = u;
 		return u;
@@ -764,10 +847,9 @@ public:
 		 * algorithm. It also initializes a new ROBDD variable to store the
 		 * restricted ROBDD.
 		 */
-		Reduced->T[0][var_index] = Reduced->T[1][var_index] = numVars;
-		Reduced->T[1][varnum] = 1; Reduced->T[0][varnum] = 0;
-		Reduced->T[1][low_node] = 1; Reduced->T[0][low_node] = 0;
-		Reduced->T[1][high_node] = 1; Reduced->T[0][high_node] = 0;
+		Reduced->T[0].level = Reduced->T[1].level = numVars;
+		Reduced->T[1].low = 1; Reduced->T[0].low = 0;
+		Reduced->T[1].high = 1; Reduced->T[0].high = 0;
 		Reduced->index_u = 2;
 		res(u,j,b,Reduced);
 	}
@@ -785,18 +867,18 @@ public:
 		else if(u==1){
 			return 1;
 		}
-		if(T[u][var_index] > j){
-			R->Mk(T[u][var_index],T[u][low_node],T[u][high_node]);
-			return T[u][varnum];
+		if(T[u].level > j){
+			R->Mk(T[u].level,T[u].low,T[u].high);
+			return u;
 		}
-		else if(T[u][var_index] < j){
-				return (R->Mk(T[u][var_index], res(T[u][low_node],j,b,R),res(T[u][high_node],j,b,R)));
+		else if(T[u].level < j){
+				return (R->Mk(T[u].level, res(T[u].low,j,b,R),res(T[u].high,j,b,R)));
 		}
 		else if(b == 0){
-			return res(T[u][low_node],j,b,R);
+			return res(T[u].low,j,b,R);
 		}
 		else{
-			return res(T[u][high_node],j,b,R);
+			return res(T[u].high,j,b,R);
 		}
 	}
 
@@ -804,7 +886,7 @@ public:
 		/*
 		 * Implements the SatCount algorithm from the Andersen paper.
 		 */
-		return pow(2,((T[u][var_index]-1)))*count(T[u][varnum]) ;
+		return pow(2,((T[u].level-1)))*count(u) ;
 	}
 
 	int count(unsigned u){
@@ -821,10 +903,10 @@ public:
 			return 1;
 		}
 		else{
-			index_low = T[u][low_node];
-			val = pow(2,((T[index_low][var_index] - T[u][var_index] - 1)))*count(T[u][low_node]);
-			index_high = T[u][high_node];
-			val += pow(2,((T[index_high][var_index] - T[u][var_index] - 1)))*count(T[u][high_node]);
+			index_low = T[u].low;
+			val = pow(2,((T[index_low].level - T[u].level - 1)))*count(T[u].low);
+			index_high = T[u].high;
+			val += pow(2,((T[index_high].level - T[u].level - 1)))*count(T[u].high);
 
 			return val;
 		}
@@ -844,16 +926,16 @@ public:
 		 * Implements the recursive operation of AnySat algorithm
 		 */
 		int val = -1;
-		if(T[u][varnum] == 0){
+		if(u == 0){
 			return 0;
 		}
-		else if(T[u][varnum] == 1){
+		else if(u == 1){
 			return -1;
 		}
-		else if(T[u][low_node] == 0){
+		else if(T[u].low == 0){
 			arr[setSize] = 1;
 			setSize++;
-			val = AnySat_(T[u][high_node]);
+			val = AnySat_(T[u].high);
 			if(val!= -1){
 				arr[setSize] = val;
 			}
@@ -862,7 +944,7 @@ public:
 
 			arr[setSize] = 0;
 			setSize++;
-			val = AnySat_(T[u][low_node]);
+			val = AnySat_(T[u].low);
 			if( val != -1){
 				arr[setSize] = val;
 				}
@@ -871,207 +953,4270 @@ public:
 		}
 };
 
-void Apply_ROBDD(ROBDD k, unsigned numVar_k){
+class bddManager{
+
 	/*
-	 * Wrapper function to Apply(). It accepts and parses another
-	 * boolean expression, creates it's ROBDDD and calls the Apply operation
-	 * on both the ROBDDs.
+	 * This class defines a shared ROBDD manager. Unlike ROBDD, which keeps one table T
+	 * per boolean expression, every function built by a manager lives in the same table T.
+	 * For a fixed variable order the table is canonical, hence two functions are equivalent
+	 * iff they are represented by the same node u. Checking equivalence is then a single
+	 * comparison of the roots.
+	 *
+	 * T is a contiguous array of packed bddNodes, where the level of a node is the position
+	 * of its variable in the variable order instead of the variable number. The terminal
+	 * nodes 0/1 sit on level numVars, i.e. below all variables.
+	 *
+	 * The unique table H is split into one subtable per level, each one a power of 2
+	 * array of buckets whose nodes are chained through bddNode::next. A lookup in Mk()
+	 * only touches the nodes of one level, and swapping two adjacent levels (for
+	 * variable reordering) only rehashes the nodes of those two levels.
+	 *
+	 * Results of Apply() are memoized in a computed table G of fixed size. Unlike the G
+	 * table of ROBDD, an entry may be overwritten by a colliding entry (it is a cache).
+	 *
+	 * Operations run under a resource governor (see bddLimits). When a limit is hit no
+	 * further node is made, the recursion unwinds and the operation returns BDD_ABORTED,
+	 * read_status() telling which limit stopped it. Nodes made before the abort are
+	 * valid nodes, so the manager stays consistent and the operation may be retried,
+	 * e.g. after gc() or reorder(). Operations given BDD_ABORTED return BDD_ABORTED,
+	 * so a chain of operations needs a single check at the end.
 	 */
 
-	char input[1000];	unsigned optr,c;
-	parser p2;		abSyntaxTree* exp_2;
-	ROBDD m;
-
-	printf("\nEnter next expression: ");
-	fflush(stdout);
- 	while ( (c = getchar()) != '\n' && c != EOF );
-	fgets(input,MAX_LINE_SIZE,stdin);
-		if( input == NULL){
-			printf("\nIncorrect input");
-			fflush(stdout);
-		}
-	printf("%s",input);
-	fflush(stdout);
-	exp_2 = p2.formulaWrapper(input);
-	m.ROBDD_init(p2.numVar, p2.variables,p2.var_list, exp_2);
-	m.build();
-	ROBDD r;
-scan:
-/*
- * Presents choice of Operations on ROBDD
- */
-	printf("\n Enter Operand key: \n[1]AND\n[2]OR\n[3]IMPL\n[4]EQUIV");
-	fflush(stdout);
-	scanf("%d",&optr);
-	printf(" %d",optr);
-	if(optr>0 && optr<5){
-		m.Apply(&k,optr);
-	}
+public:
+	// how build() and ApplyN() choose the next two operands of an n-ary AND/OR
+	enum naryMode {NARY_SMALLEST, NARY_SUPPORT};
 
-	else{
-		printf("invalid choice\n\n");
-		fflush(stdout);
-		goto scan;
-	}
-	// prints out the adjacency list of the new ROBDD
-	for(unsigned i = 0; i< (m.read_index() +1); i++){
-		printf("\n%d %d %d %d", m.T[i][0],m.T[i][1],m.T[i][2],m.T[i][3]);
-		fflush(stdout);
-	}
+protected:
+	// operations of the computed table beyond the binary operators of oprtr
+	enum cacheOp {OP_ANDEXISTS = invalid + 1, OP_REPLACE, OP_SIMPLIFY, OP_LAST};
 
-}
+	struct cacheEntry{
+		unsigned op, u1, u2, u3, u;
+	};
 
-void Restrict_ROBDD(ROBDD k, unsigned NumVars){
-	/*
-	 * Wrapper to the Restrict function. It accepts the variable and it's
-	 * assignemnt with which to restrict the given ROBDD.
-	 */
-	ROBDD temp;
-	unsigned index,val;
-	fflush(stdout);
-	printf("\n Enter the variable which you wish to Restrict with: "); fflush(stdout);
-	scanf(" x%d",&index);
-	printf("\nIndex: %d\n Enter value to co-factor (0/1): ",index); fflush(stdout);
-	scanf(" %d",&val);
-	k.build();
-    k.Restrict(NumVars+2,(unsigned)index,val, &temp);
+	struct subtable{
+		std::vector<unsigned> buckets;	// first node of each chain (0 => empty)
+		unsigned count;					// nodes in the subtable
+	};
 
-	printf("\nRestricted Adjacency List:");
-	fflush(stdout);
+	unsigned numVars;
+	std::vector<bddNode> T;
+	std::vector<subtable> H;			// one unique subtable per level
+	std::vector<cacheEntry> G;
+	std::vector<unsigned> order;		// level -> variable number
+	std::vector<unsigned> levelOf;		// variable number -> level
+	std::vector< std::vector<unsigned> > varMaps;	// renamings registered for Replace()
+	std::vector<unsigned> freeList;		// nodes freed by gc(), reused by findOrAdd()
+	std::map<unsigned, unsigned> refs;	// reference count of the roots kept by gc()
+	unsigned long long bucketCount;		// buckets of all subtables, for memoryBytes()
+	naryMode nary;
 
-	//prints the Adjacency List of the  restricted ROBDD
-    for(unsigned i = 0; i<temp.read_index() + 1; i++){
-    			printf("\n%d %d %d %d", temp.T[i][0],temp.T[i][1],temp.T[i][2],temp.T[i][3]);
-    			fflush(stdout);
-    		}
-}
+	typedef std::chrono::steady_clock clk;
+	bddLimits global, perOp;
+	clk::time_point globalStart, opStart;
+	bddStatus status;					// status of the current operation
+	bddStatus lastAbort;				// reason of the last abort, see read_status()
+	unsigned depth;						// nesting of public operations, 0 => not governed
+	unsigned long long opNodes;			// nodes made by the current operation
+	unsigned long long opBytes;			// memoryBytes() when the current operation started
+	unsigned ticks;
+	const std::atomic<unsigned long long> *nodeBar;
 
-void SatCount_ROBDD(ROBDD k, int numVar){
-	/*
-	 * Wrapper to SatCount function. Allows the user to choose between
-	 * computing for all nodes or for a specific node. It accepts the variable
-	 * number as input.
-	 */
-	int val, option,u, index;
-	printf("\nprint for all nodes? (Yes = 1 / No = 0)"); fflush(stdout);
-	scanf("%d",&option);
-	index= k.read_index();
-	if(!option){
-		printf("\n Enter Node number (u) : "); fflush(stdout);
-		scanf("%d",&u);
-		val = k.SatCount(u);
-		printf("\nNo. of values that satisfy node %d = %d ", u, val); fflush(stdout);
+	unsigned pair(unsigned i, unsigned j){
+		/*
+		 * Same pairing function as ROBDD, used to hash entries of the computed table.
+		 */
+		return (((i+j)*(i+j+1))/2 + i);
+	}
 
+	unsigned hash(unsigned i, unsigned j, unsigned k){
+		return (pair(i,pair(j,k)) & (CACHE_SIZE - 1));
 	}
-	else{
-		for (int i = 0; i < index ; i++){
-			val = k.SatCount(i);
-			printf("\nNo. of values that satisfy node %d = %d ", k.T[i][0], val); fflush(stdout);
+
+	bool cacheLookup(unsigned op, unsigned u1, unsigned u2, unsigned u3, unsigned &u){
+		/*
+		 * Looks up the result of op(u1,u2,u3) in the computed table. Binary
+		 * operators pass u3 = 0.
+		 */
+		cacheEntry &c = G[hash(op,u1,pair(u2,u3))];
+		if(c.op == op && c.u1 == u1 && c.u2 == u2 && c.u3 == u3){
+			u = c.u;
+			return true;
 		}
+		return false;
 	}
-}
 
-void AnySat_ROBDD(ROBDD k, int numVar){
-	/*
-	 * Wrapper to SatCount function. Allows the user to choose between
-	 * computing for all nodes or for a specific node. It accepts the variable
-	 * number as input.
-	 */
-	int val, option,u, index;
-	index = k.read_index();
-	printf("\nprint for all nodes?(Yes = 1 / No = 0)"); fflush(stdout);
-	scanf("%d",&option);
-	if(!option){
-		printf("\n Enter Node number (u) : "); fflush(stdout);
-		scanf("%d",&u);
-		val = k.SatCount(u);
-		printf("\nNo. of values that satisfy node %d = %d ", u, val); fflush(stdout);
+	void cacheInsert(unsigned op, unsigned u1, unsigned u2, unsigned u3, unsigned u){
+		if(status != BDD_OK){
+			// u may be the placeholder of an aborted operation
+			return;
+		}
+		cacheEntry &c = G[hash(op,u1,pair(u2,u3))];
+		c.op = op; c.u1 = u1; c.u2 = u2; c.u3 = u3; c.u = u;
+	}
 
+	unsigned bucket(const subtable &st, unsigned l, unsigned h){
+		return ((l * 2654435761u) ^ (h * 40503u + (h >> 7))) & (st.buckets.size() - 1);
 	}
-	else{
-			for (int i = 0; i < index ; i++){
-				k.AnySat(i);
-				printf("\nSatisfiability set for node%d : [", k.T[i][0]); fflush(stdout);
-				for (unsigned j = 0; j < k.setSize ; j++){
-					printf(" %d", k.arr[j]);
-				}
-				printf(" ]"); fflush(stdout);
 
+	void insertInH(unsigned u){
+		/*
+		 * Chains node u into the subtable of its level, doubling the subtable
+		 * when it holds more than two nodes per bucket on average.
+		 */
+		subtable &st = H[T[u].level];
+		if(st.count >= 2*st.buckets.size()){
+			std::vector<unsigned> old;
+			old.swap(st.buckets);
+			st.buckets.assign(2*old.size(), 0);
+			bucketCount += old.size();
+			for(unsigned b = 0; b < old.size(); b++){
+				unsigned v = old[b], nv;
+				while(v != 0){
+					nv = T[v].next;
+					unsigned k = bucket(st, T[v].low, T[v].high);
+					T[v].next = st.buckets[k];
+					st.buckets[k] = v;
+					v = nv;
+				}
 			}
+		}
+		unsigned k = bucket(st, T[u].low, T[u].high);
+		T[u].next = st.buckets[k];
+		st.buckets[k] = u;
+		st.count++;
 	}
-}
-
-int main(){
-	/*
-	 * Where the Magic Happens!!
-	 *
-	 * The main function is designed to serve as a UI to the whole application.
-	 * It has a Menu system that allows the user to choose which operation must be performed
-	 * on the ROBDD.
-	 */
-
 
-	abSyntaxTree *exp_1;
-	ROBDD k; parser p1;
+	void clearSubtable(unsigned i){
+		H[i].buckets.assign(H[i].buckets.size(), 0);
+		H[i].count = 0;
+	}
 
+	bool elapsed(const clk::time_point &start, double seconds){
+		return seconds > 0 && std::chrono::duration<double>(clk::now() - start).count() > seconds;
+	}
 
-	char input[MAX_LINE_SIZE];
-	char *copy;
-	int option,c;
+	bool interrupted(){
+		/*
+		 * Periodic check of the limits that do not grow with each node: the time
+		 * limits and the node bar set by another thread (see setNodeBar()).
+		 */
+		if(elapsed(globalStart, global.maxSeconds) || elapsed(opStart, perOp.maxSeconds)){
+			status = BDD_TIME_LIMIT;
+		}
+		else if(nodeBar != NULL && liveNodes() > nodeBar->load(std::memory_order_relaxed)){
+			status = BDD_CANCELLED;
+		}
+		return status != BDD_OK;
+	}
 
-new_exp:	// prompt user for boolean expression. Example expression given to explain grammar
+	bool outOfSpace(){
+		/*
+		 * Called before a node is made. The byte count is an estimate of the memory
+		 * held by T, H and G, which is what grows with the number of nodes.
+		 */
+		unsigned long long bytes = memoryBytes();
+		if((global.maxNodes && liveNodes() >= global.maxNodes) ||
+		   (perOp.maxNodes && opNodes >= perOp.maxNodes)){
+			status = BDD_NODE_LIMIT;
+		}
+		else if((global.maxBytes && bytes >= global.maxBytes) ||
+				(perOp.maxBytes && bytes >= opBytes + perOp.maxBytes)){
+			status = BDD_MEMORY_LIMIT;
+		}
+		return status != BDD_OK;
+	}
 
-printf(" Enter formulae of proposition logic, one per line (max %d characters)", MAX_LINE_SIZE);fflush(stdout);
-	printf("\n Syntax is prefix. \nEg: ((!F OR F) IMPL ((F EQUIV T) AND T) in infix becomes");fflush(stdout);
-	printf("\n (IMPL (OR F (NOT F)) (AND (EQUIV F T) T)) in prefix \n");
-	fflush(stdout);
-	//fgets(input,MAX_LINE_SIZE,stdin);
-	if( input == NULL){
-		printf("\nIncorrect input");
-		goto new_exp;
+	bool beginOp(unsigned u1, unsigned u2 = BDD_FALSE, unsigned u3 = BDD_FALSE){
+		/*
+		 * Entry of every public operation. Only the outermost operation resets the
+		 * status and the per operation counters. Returns false if an argument is
+		 * the result of an aborted operation.
+		 */
+		if(u1 == BDD_ABORTED || u2 == BDD_ABORTED || u3 == BDD_ABORTED){
+			return false;
+		}
+		if(depth++ == 0){
+			status = BDD_OK;
+			opNodes = 0;
+			opBytes = memoryBytes();
+			opStart = clk::now();
+			ticks = 0;
+		}
+		return true;
 	}
-	//printf("\n%s",input);
-	//copy = input;
-	copy = BIG_TEST_STRING; 	
-	exp_1 = p1.formulaWrapper(copy);
-	k.ROBDD_init(p1.numVar,p1.variables,p1.var_list, exp_1);
-	k.build();
 
-	printf("\nPrinting Adjacency List of ROBDD.\nNote: Constant nodes 0/1 will be mapped to themselves\n"); fflush(stdout);
-	printf("\nu i l h"); fflush(stdout);
-// print adjacency list of Boolean expression received from user
-	for(unsigned i = 0; i<=k.read_index(); i++){
-			printf("\n%d %d %d %d", k.T[i][0],k.T[i][1],k.T[i][2],k.T[i][3]);
-			fflush(stdout);
+	unsigned endOp(unsigned u){
+		if(--depth == 0 && status != BDD_OK){
+			lastAbort = status;
+			return BDD_ABORTED;
 		}
-menu:
-// Menu of Choices for operations on ROBDD
-	printf("\n\n\tMENU\n \n1.Apply\n2.Restrict\n3.Satisfiability Count\n4.AnySat check\n5.Enter new expression\n6.QUIT");
-	fflush(stdout);
-	printf("\nEnter Operation you wish to perform:");
-	fflush(stdout);
-	//scanf("%d",&option);
-	option = 6;
+		return u;
+	}
 
-	if(option < 0 && option > 7){
-		printf("INVALID option. Program Terminated.");
-		fflush(stdout);
-		exit(0);
+	unsigned findOrAdd(unsigned i, unsigned l, unsigned h){
+		/*
+		 * Returns the node (i,l,h), adding it to T and H if it does not exist yet.
+		 * Unlike Mk() no reduction rule is applied here. Inside an operation the
+		 * limits are checked here, since every new node goes through findOrAdd(),
+		 * and BDD_FALSE is returned once a limit is hit (the result is discarded).
+		 */
+		if(depth > 0 && (status != BDD_OK || ((++ticks & 1023) == 0 && interrupted()))){
+			return BDD_FALSE;
+		}
+		subtable &st = H[i];
+		for(unsigned u = st.buckets[bucket(st,l,h)]; u != 0; u = T[u].next){
+			if(T[u].low == l && T[u].high == h){
+				return u;
+			}
+		}
+		if(depth > 0 && outOfSpace()){
+			return BDD_FALSE;
+		}
+		unsigned u;
+		if(!freeList.empty()){
+			u = freeList.back();
+			freeList.pop_back();
+			T[u] = {i,l,h,0};
+		}
+		else{
+			u = T.size();
+			T.push_back({i,l,h,0});
+		}
+		opNodes++;
+		insertInH(u);
+		return u;
 	}
-	switch(option){
-	case 1: Apply_ROBDD(k, p1.numVar);
-		goto menu; break;
-	case 2: Restrict_ROBDD(k,p1.numVar);
-		goto menu; break;
-	case 3: SatCount_ROBDD(k,p1.numVar);
-		goto menu; break;
-	case 4: AnySat_ROBDD(k,p1.numVar);
-		goto menu; break;
-	case 5:  while ( (c = getchar()) != '\n' && c != EOF );
-		goto new_exp;
 
+	unsigned operate(unsigned op, unsigned v1, unsigned v2){
+		/*
+		 * Called by Apply_() to operate on terminal nodes.
+		 */
+		switch(op){
+			case OR:    return (v1 | v2);
+			case AND:   return (v1 & v2);
+			case IMPL:  return (v1 ? v2 : 1);
+			case EQUIV: return (v1 == v2);
+			case XOR:   return (v1 != v2);
+			default:
+				printf("\nINVALID OPERATOR. %d", op);
+				exit(0);
+		}
+	}
 
-	case 6: printf("\n\nThank you for your time! Program Terminated."); fflush(stdout);break;
+	unsigned Apply_(unsigned op, unsigned u1, unsigned u2){
+		/*
+		 * Performs the recursive operation of the Apply algorithm. Both operands
+		 * belong to this manager, so the cofactors are taken with respect to the
+		 * top-most level of the two nodes.
+		 */
+		unsigned u, i, l1, h1, l2, h2;
+		if(u1 <= BDD_TRUE && u2 <= BDD_TRUE){
+			return operate(op,u1,u2);
+		}
+		if(status != BDD_OK){
+			return BDD_FALSE;
+		}
+		switch(op){
+			case AND:
+				if(u1 == BDD_FALSE || u2 == BDD_FALSE) return BDD_FALSE;
+				if(u1 == BDD_TRUE || u1 == u2) return u2;
+				if(u2 == BDD_TRUE) return u1;
+				break;
+			case OR:
+				if(u1 == BDD_TRUE || u2 == BDD_TRUE) return BDD_TRUE;
+				if(u1 == BDD_FALSE || u1 == u2) return u2;
+				if(u2 == BDD_FALSE) return u1;
+				break;
+			case IMPL:
+				if(u1 == BDD_FALSE || u2 == BDD_TRUE || u1 == u2) return BDD_TRUE;
+				if(u1 == BDD_TRUE) return u2;
+				break;
+			case EQUIV:
+				if(u1 == u2) return BDD_TRUE;
+				break;
+			case XOR:
+				if(u1 == u2) return BDD_FALSE;
+				if(u1 == BDD_FALSE) return u2;
+				if(u2 == BDD_FALSE) return u1;
+				break;
+		}
+		if(op != IMPL && u1 > u2){
+			// commutative operators are normalized to improve the hit rate of G
+			std::swap(u1,u2);
+		}
+		if(cacheLookup(op,u1,u2,0,u)){
+			return u;
+		}
+		i = std::min(T[u1].level, T[u2].level);
+		l1 = h1 = u1;
+		l2 = h2 = u2;
+		if(T[u1].level == i){
+			l1 = T[u1].low; h1 = T[u1].high;
+		}
+		if(T[u2].level == i){
+			l2 = T[u2].low; h2 = T[u2].high;
+		}
+		u = Mk(i, Apply_(op,l1,l2), Apply_(op,h1,h2));
+		cacheInsert(op,u1,u2,0,u);
+		return u;
+	}
+
+	unsigned build_(abSyntaxTree *node, bool *varBase){
+		/*
+		 * Builds the ROBDD of a sub-tree bottom up with Apply(), instead of
+		 * evaluating the tree for every assignment like ROBDD::build_() does.
+		 */
+		if(status != BDD_OK){
+			return BDD_FALSE;
+		}
+		switch(node->type){
+			case oprtr::T: return BDD_TRUE;
+			case oprtr::F: return BDD_FALSE;
+			case var: return ithVar((unsigned)(node->data - varBase) + 1);
+			case NOT: return Not(build_(node->lptr, varBase));
+			case AND:
+			case OR:{
+				std::vector<abSyntaxTree*> operands;
+				std::vector<unsigned> roots;
+				flatten(node, node->type, operands);
+				for(unsigned k = 0; k < operands.size(); k++){
+					roots.push_back(build_(operands[k], varBase));
+				}
+				return combine(node->type, roots);
+			}
+			default:
+				return Apply(node->type, build_(node->lptr, varBase), build_(node->rptr, varBase));
+		}
+	}
+
+	void flatten(abSyntaxTree *node, int op, std::vector<abSyntaxTree*> &operands){
+		/*
+		 * Collects the operands of a chain of the associative operator op, so that
+		 * (AND a (AND b c)) and (AND (AND a b) c) both become the n-ary AND of a, b, c.
+		 */
+		if(node->type == op){
+			flatten(node->lptr, op, operands);
+			flatten(node->rptr, op, operands);
+		}
+		else{
+			operands.push_back(node);
+		}
+	}
+
+	unsigned shared(const std::vector<unsigned> &s1, const std::vector<unsigned> &s2){
+		/*
+		 * Number of variables common to two supports (both sorted by level).
+		 */
+		unsigned n = 0;
+		for(unsigned i = 0, j = 0; i < s1.size() && j < s2.size(); ){
+			if(s1[i] == s2[j]){
+				n++; i++; j++;
+			}
+			else if(levelOf[s1[i]] < levelOf[s2[j]]){
+				i++;
+			}
+			else{
+				j++;
+			}
+		}
+		return n;
+	}
+
+	unsigned combine(unsigned op, std::vector<unsigned> roots){
+		/*
+		 * AND/OR of any number of operands. Building a chain in the order it was
+		 * written carries one growing intermediate result through the whole chain.
+		 * Instead the smallest operand is always combined with the next smallest
+		 * (NARY_SMALLEST), or with the operand sharing the most support variables
+		 * with it (NARY_SUPPORT), so small operands constrain each other before
+		 * they meet the large ones.
+		 */
+		unsigned absorbing = (op == AND) ? BDD_FALSE : BDD_TRUE;
+		std::vector<unsigned> sizes;
+		std::vector< std::vector<unsigned> > supports;
+		unsigned a, b, r, k;
+
+		if(roots.empty()){
+			return (op == AND) ? BDD_TRUE : BDD_FALSE;
+		}
+		for(k = 0; k < roots.size(); k++){
+			if(roots[k] == absorbing){
+				return absorbing;
+			}
+			sizes.push_back(size(roots[k]));
+			if(nary == NARY_SUPPORT){
+				supports.push_back(support(roots[k]));
+			}
+		}
+		while(roots.size() > 1){
+			if(status != BDD_OK){
+				return BDD_FALSE;
+			}
+			a = std::min_element(sizes.begin(), sizes.end()) - sizes.begin();
+			b = (a == 0) ? 1 : 0;
+			for(k = 0; k < roots.size(); k++){
+				if(k == a || k == b){
+					continue;
+				}
+				if(nary == NARY_SUPPORT){
+					unsigned sk = shared(supports[a], supports[k]), sb = shared(supports[a], supports[b]);
+					if(sk > sb || (sk == sb && sizes[k] < sizes[b])){
+						b = k;
+					}
+				}
+				else if(sizes[k] < sizes[b]){
+					b = k;
+				}
+			}
+			r = Apply_(op, roots[a], roots[b]);
+			if(r == absorbing){
+				return absorbing;
+			}
+			roots[a] = r;
+			sizes[a] = size(r);
+			if(nary == NARY_SUPPORT){
+				supports[a] = support(r);
+			}
+			roots[b] = roots.back(); roots.pop_back();
+			sizes[b] = sizes.back(); sizes.pop_back();
+			if(nary == NARY_SUPPORT){
+				supports[b].swap(supports.back());
+				supports.pop_back();
+			}
+		}
+		return roots[0];
+	}
+
+	unsigned AndExists_(unsigned f, unsigned g, unsigned cube){
+		/*
+		 * Relational product: computes (exists cube. f AND g) in a single pass, so the
+		 * conjunction is never built in full before the variables are quantified away.
+		 * cube is the conjunction of the (positive) variables to quantify.
+		 */
+		unsigned u, i, fl, fh, gl, gh, r0, r1;
+		if(f == BDD_FALSE || g == BDD_FALSE || status != BDD_OK){
+			return BDD_FALSE;
+		}
+		if(f == BDD_TRUE && g == BDD_TRUE){
+			return BDD_TRUE;
+		}
+		if(f == BDD_TRUE || f == g){
+			f = g; g = BDD_TRUE;
+		}
+		i = std::min(T[f].level, T[g].level);
+		while(cube > BDD_TRUE && T[cube].level < i){
+			cube = T[cube].high;
+		}
+		if(cube <= BDD_TRUE){
+			return Apply_(AND,f,g);
+		}
+		if(g != BDD_TRUE && f > g){
+			std::swap(f,g);
+		}
+		if(cacheLookup(OP_ANDEXISTS,f,g,cube,u)){
+			return u;
+		}
+		fl = fh = f;
+		gl = gh = g;
+		if(T[f].level == i){
+			fl = T[f].low; fh = T[f].high;
+		}
+		if(T[g].level == i){
+			gl = T[g].low; gh = T[g].high;
+		}
+		if(T[cube].level == i){
+			r0 = AndExists_(fl,gl,T[cube].high);
+			if(r0 == BDD_TRUE){
+				u = BDD_TRUE;
+			}
+			else{
+				r1 = AndExists_(fh,gh,T[cube].high);
+				u = Apply_(OR,r0,r1);
+			}
+		}
+		else{
+			u = Mk(i, AndExists_(fl,gl,cube), AndExists_(fh,gh,cube));
+		}
+		cacheInsert(OP_ANDEXISTS,f,g,cube,u);
+		return u;
+	}
+
+	unsigned Replace_(unsigned u, unsigned mapId){
+		/*
+		 * Renames the variables of u according to the level map mapId. If the renamed
+		 * level still lies above the levels of both children Mk() is used directly,
+		 * otherwise the node is rebuilt with an if-then-else.
+		 */
+		unsigned r, l, h, i, v;
+		if(u <= BDD_TRUE || status != BDD_OK){
+			return u;
+		}
+		if(cacheLookup(OP_REPLACE,u,mapId,0,r)){
+			return r;
+		}
+		l = Replace_(T[u].low, mapId);
+		h = Replace_(T[u].high, mapId);
+		i = levelOf[varMaps[mapId][order[T[u].level]]];
+		if(i < T[l].level && i < T[h].level){
+			r = Mk(i,l,h);
+		}
+		else{
+			v = Mk(i, BDD_FALSE, BDD_TRUE);
+			r = Apply_(OR, Apply_(AND,v,h), Apply_(AND,Not(v),l));
+		}
+		cacheInsert(OP_REPLACE,u,mapId,0,r);
+		return r;
+	}
+
+	unsigned Simplify_(unsigned f, unsigned c){
+		/*
+		 * Recursive operation of Simplify(), the restrict operator of Coudert and Madre.
+		 */
+		unsigned u, i, fl, fh, cl, ch;
+		if(c == BDD_TRUE || f <= BDD_TRUE){
+			return f;
+		}
+		if(c == BDD_FALSE || status != BDD_OK){
+			return BDD_FALSE;
+		}
+		if(cacheLookup(OP_SIMPLIFY,f,c,0,u)){
+			return u;
+		}
+		i = T[f].level;
+		if(T[c].level < i){
+			// f does not depend on the top variable of c, so drop it from the care set
+			u = Simplify_(f, Apply_(OR, T[c].low, T[c].high));
+		}
+		else{
+			fl = T[f].low; fh = T[f].high;
+			cl = ch = c;
+			if(T[c].level == i){
+				cl = T[c].low; ch = T[c].high;
+			}
+			if(cl == BDD_FALSE){
+				u = Simplify_(fh,ch);
+			}
+			else if(ch == BDD_FALSE){
+				u = Simplify_(fl,cl);
+			}
+			else{
+				u = Mk(i, Simplify_(fl,cl), Simplify_(fh,ch));
+			}
+		}
+		cacheInsert(OP_SIMPLIFY,f,c,0,u);
+		return u;
+	}
+
+	double minCost(unsigned u, const std::vector<double> &c0, const std::vector<double> &c1,
+				   const std::vector<double> &skip, std::vector<double> &memo){
+		/*
+		 * Cost of the cheapest path from u to terminal 1. c0/c1 hold the cost of
+		 * the negative/positive literal of each level, and skip[i] is the cost of
+		 * choosing the cheaper literal on every level above i, so the variables
+		 * skipped by an edge cost skip[to] - skip[from + 1].
+		 */
+		if(u == BDD_FALSE){
+			return INFINITY;
+		}
+		if(u == BDD_TRUE){
+			return 0;
+		}
+		if(memo[u] >= 0){
+			return memo[u];
+		}
+		unsigned i = T[u].level, l = T[u].low, h = T[u].high;
+		double viaLow  = c0[i] + skip[T[l].level] - skip[i+1] + minCost(l,c0,c1,skip,memo);
+		double viaHigh = c1[i] + skip[T[h].level] - skip[i+1] + minCost(h,c0,c1,skip,memo);
+		memo[u] = std::min(viaLow, viaHigh);
+		return memo[u];
+	}
+
+	double probability(unsigned u, const std::vector<double> &p, std::vector<double> &memo){
+		/*
+		 * Probability that u is true when the variable of level i is true with
+		 * probability p[i], independently of the others.
+		 */
+		if(u <= BDD_TRUE){
+			return u;
+		}
+		if(memo[u] < 0){
+			double pi = p[T[u].level];
+			memo[u] = (1 - pi)*probability(T[u].low,p,memo) + pi*probability(T[u].high,p,memo);
+		}
+		return memo[u];
+	}
+
+	double count(unsigned u, std::vector<double> &memo){
+		/*
+		 * Same as ROBDD::count() but memoized, since nodes are shared between
+		 * several paths of the manager.
+		 */
+		if(u <= BDD_TRUE){
+			return u;
+		}
+		if(memo[u] >= 0){
+			return memo[u];
+		}
+		unsigned l = T[u].low, h = T[u].high;
+		memo[u] = pow(2, T[l].level - T[u].level - 1)*count(l,memo) +
+				  pow(2, T[h].level - T[u].level - 1)*count(h,memo);
+		return memo[u];
+	}
+
+public:
+
+	bddManager(unsigned max_size){
+		/*
+		 * Initializes the terminal nodes and the identity variable order,
+		 * i.e. variable x(k) sits on level k-1.
+		 */
+		numVars = max_size;
+		T.push_back({numVars,0,0,0});
+		T.push_back({numVars,1,1,0});
+		H.resize(numVars);
+		for(unsigned i = 0; i < numVars; i++){
+			H[i].buckets.assign(64, 0);
+			H[i].count = 0;
+		}
+		bucketCount = 64ULL*numVars;
+		nary = NARY_SMALLEST;
+		G.assign(CACHE_SIZE, {invalid,0,0,0,0});
+		order.resize(numVars);
+		levelOf.resize(numVars + 1);
+		for(unsigned i = 0; i < numVars; i++){
+			order[i] = i+1;
+			levelOf[i+1] = i;
+		}
+		global = perOp = {0, 0, 0};
+		globalStart = opStart = clk::now();
+		status = lastAbort = BDD_OK;
+		depth = 0;
+		opNodes = opBytes = 0;
+		ticks = 0;
+		nodeBar = NULL;
+	}
+
+	void setLimits(const bddLimits &limits){
+		/*
+		 * Sets the global limits. The time limit counts from this call.
+		 */
+		global = limits;
+		globalStart = clk::now();
+	}
+
+	void setOperationLimits(const bddLimits &limits){
+		/*
+		 * Sets the limits applied to each public operation on its own.
+		 */
+		perOp = limits;
+	}
+
+	void setNodeBar(const std::atomic<unsigned long long> *bar){
+		/*
+		 * Operations are cancelled (BDD_CANCELLED) once the live nodes exceed *bar,
+		 * which may be lowered by another thread at any time. NULL => no bar.
+		 */
+		nodeBar = bar;
+	}
+
+	bddStatus read_status(){
+		/*
+		 * The limit that stopped the last aborted operation, BDD_OK if no operation
+		 * was aborted since the manager was made or clearStatus() was called.
+		 */
+		return lastAbort;
+	}
+
+	void clearStatus(){
+		lastAbort = BDD_OK;
+	}
+
+	unsigned long long liveNodes(){
+		return T.size() - freeList.size();
+	}
+
+	unsigned long long memoryBytes(){
+		return T.capacity()*sizeof(bddNode) + bucketCount*sizeof(unsigned) +
+			   G.size()*sizeof(cacheEntry) + freeList.capacity()*sizeof(unsigned);
+	}
+
+	void ref(unsigned u){
+		/*
+		 * Marks u as a root that gc() must keep. Calls to ref() and deref() nest.
+		 */
+		if(u != BDD_ABORTED){
+			refs[u]++;
+		}
+	}
+
+	void deref(unsigned u){
+		std::map<unsigned, unsigned>::iterator it = refs.find(u);
+		if(it != refs.end() && --it->second == 0){
+			refs.erase(it);
+		}
+	}
+
+	unsigned gc(){
+		/*
+		 * Frees every node not reachable from a root marked by ref(). Node numbers
+		 * of the remaining nodes do not change, freed numbers are reused by later
+		 * nodes. The computed table is cleared since it may refer to freed nodes.
+		 * Terminals are never freed. Returns the number of nodes freed.
+		 */
+		std::vector<bool> mark(T.size(), false);
+		std::vector<unsigned> stack;
+		unsigned freed = 0;
+
+		for(std::map<unsigned, unsigned>::iterator it = refs.begin(); it != refs.end(); it++){
+			stack.push_back(it->first);
+		}
+		while(!stack.empty()){
+			unsigned v = stack.back();
+			stack.pop_back();
+			if(mark[v]){
+				continue;
+			}
+			mark[v] = true;
+			if(T[v].level != numVars){
+				stack.push_back(T[v].low);
+				stack.push_back(T[v].high);
+			}
+		}
+		for(unsigned i = 0; i < numVars; i++){
+			clearSubtable(i);
+		}
+		for(unsigned u = 0; u < T.size(); u++){
+			if(T[u].level == numVars || T[u].level == BDD_FREE_LEVEL){
+				continue;
+			}
+			if(mark[u]){
+				insertInH(u);
+			}
+			else{
+				T[u].level = BDD_FREE_LEVEL;
+				freeList.push_back(u);
+				freed++;
+			}
+		}
+		G.assign(CACHE_SIZE, {invalid,0,0,0,0});
+		return freed;
+	}
+
+	bool setOrder(const unsigned *ids, unsigned count){
+		/*
+		 * Places the variables listed in ids on the top levels (in that order), the
+		 * remaining variables keep their relative order below them. Only allowed
+		 * while the manager holds no nodes other than the terminals.
+		 */
+		if(T.size() > 2){
+			return false;
+		}
+		std::vector<bool> placed(numVars + 1, false);
+		unsigned lvl = 0;
+		for(unsigned k = 0; k < count; k++){
+			if(ids[k] >= 1 && ids[k] <= numVars && !placed[ids[k]]){
+				placed[ids[k]] = true;
+				order[lvl++] = ids[k];
+			}
+		}
+		for(unsigned id = 1; id <= numVars; id++){
+			if(!placed[id]){
+				order[lvl++] = id;
+			}
+		}
+		for(unsigned i = 0; i < numVars; i++){
+			levelOf[order[i]] = i;
+		}
+		return true;
+	}
+
+	void swapLevels(unsigned i){
+		/*
+		 * Swaps the variables on levels i and i+1 in place. Every node keeps the
+		 * function it represents, so node numbers held by the caller stay valid.
+		 *
+		 * A node f on level i (variable x) that depends on the variable y of level
+		 * i+1 is rewritten as y ? (x ? f11 : f01) : (x ? f10 : f00), its new children
+		 * being made on level i+1. Nodes of level i that do not depend on y simply
+		 * move to level i+1, and the nodes of level i+1 move to level i. The nodes of
+		 * the two levels are found by walking the bucket chains of their subtables, so
+		 * a swap only costs time in the size of those two levels.
+		 */
+		std::vector<unsigned> X, Y;
+		std::vector<bool> dependsOnY;
+		unsigned f, f0, f1, f00, f01, f10, f11;
+
+		if(i + 1 >= numVars){
+			return;
+		}
+		for(unsigned b = 0; b < H[i].buckets.size(); b++){
+			for(unsigned k = H[i].buckets[b]; k != 0; k = T[k].next){
+				X.push_back(k);
+				dependsOnY.push_back(T[T[k].low].level == i+1 || T[T[k].high].level == i+1);
+			}
+		}
+		for(unsigned b = 0; b < H[i+1].buckets.size(); b++){
+			for(unsigned k = H[i+1].buckets[b]; k != 0; k = T[k].next){
+				Y.push_back(k);
+			}
+		}
+		std::sort(Y.begin(), Y.end());
+		clearSubtable(i);
+		clearSubtable(i+1);
+		for(unsigned k = 0; k < Y.size(); k++){
+			T[Y[k]].level = i;
+			insertInH(Y[k]);
+		}
+		for(unsigned k = 0; k < X.size(); k++){
+			if(!dependsOnY[k]){
+				T[X[k]].level = i+1;
+				insertInH(X[k]);
+			}
+		}
+		for(unsigned k = 0; k < X.size(); k++){
+			if(dependsOnY[k]){
+				f = X[k];
+				f0 = T[f].low; f1 = T[f].high;
+				f00 = f01 = f0;
+				f10 = f11 = f1;
+				if(T[f0].level == i && f0 > BDD_TRUE && std::binary_search(Y.begin(), Y.end(), f0)){
+					f00 = T[f0].low; f01 = T[f0].high;
+				}
+				if(T[f1].level == i && f1 > BDD_TRUE && std::binary_search(Y.begin(), Y.end(), f1)){
+					f10 = T[f1].low; f11 = T[f1].high;
+				}
+				T[f].low = Mk(i+1, f00, f10);
+				T[f].high = Mk(i+1, f01, f11);
+				insertInH(f);
+			}
+		}
+		std::swap(order[i], order[i+1]);
+		levelOf[order[i]] = i;
+		levelOf[order[i+1]] = i+1;
+		// cached results of Simplify() and Change() depend on the order
+		G.assign(CACHE_SIZE, {invalid,0,0,0,0});
+	}
+
+	void reorder(const std::vector<unsigned> &ids){
+		/*
+		 * Moves the variables in ids to the top levels, in that order, using adjacent
+		 * level swaps. Unlike setOrder() this may be called at any time.
+		 */
+		for(unsigned k = 0; k < ids.size() && k < numVars; k++){
+			for(unsigned lvl = levelOf[ids[k]]; lvl > k; lvl--){
+				swapLevels(lvl - 1);
+			}
+		}
+	}
+
+	unsigned read_index(){
+		return T.size();
+	}
+
+	unsigned read_numVars(){
+		return numVars;
+	}
+
+	unsigned level(unsigned u){
+		return T[u].level;
+	}
+
+	unsigned low(unsigned u){
+		return T[u].low;
+	}
+
+	unsigned high(unsigned u){
+		return T[u].high;
+	}
+
+	unsigned varAt(unsigned lvl){
+		return order[lvl];
+	}
+
+	unsigned Mk(unsigned i, unsigned l, unsigned h){
+		/*
+		 * Implementation of the Mk[T,H] algorithm defined in the Andersen Paper
+		 */
+		if(l == BDD_ABORTED || h == BDD_ABORTED){
+			return BDD_ABORTED;
+		}
+		if(l == h){
+			return l;
+		}
+		return findOrAdd(i,l,h);
+	}
+
+	unsigned ithVar(unsigned id){
+		/*
+		 * Returns the ROBDD of the single variable x(id).
+		 */
+		return Mk(levelOf[id], BDD_FALSE, BDD_TRUE);
+	}
+
+	unsigned Apply(unsigned op, unsigned u1, unsigned u2){
+		if(!beginOp(u1,u2)){
+			return BDD_ABORTED;
+		}
+		return endOp(Apply_(op,u1,u2));
+	}
+
+	unsigned Not(unsigned u){
+		return Apply(XOR,u,BDD_TRUE);
+	}
+
+	unsigned ApplyN(unsigned op, const std::vector<unsigned> &operands){
+		/*
+		 * Conjunction (op = AND) or disjunction (op = OR) of all operands, combined
+		 * in the order chosen by setNaryMode() rather than in the given order.
+		 */
+		for(unsigned k = 0; k < operands.size(); k++){
+			if(operands[k] == BDD_ABORTED){
+				return BDD_ABORTED;
+			}
+		}
+		beginOp(BDD_FALSE);
+		return endOp(combine(op, operands));
+	}
+
+	void setNaryMode(naryMode mode){
+		nary = mode;
+	}
+
+	unsigned ithLevel(unsigned i){
+		return Mk(i, BDD_FALSE, BDD_TRUE);
+	}
+
+	unsigned levelOfVar(unsigned id){
+		return levelOf[id];
+	}
+
+	unsigned cube(const std::vector<unsigned> &ids){
+		/*
+		 * Returns the conjunction of the variables in ids, as used by AndExists().
+		 */
+		std::vector<unsigned> levels;
+		unsigned c = BDD_TRUE;
+		for(unsigned k = 0; k < ids.size(); k++){
+			levels.push_back(levelOf[ids[k]]);
+		}
+		std::sort(levels.begin(), levels.end());
+		for(int k = (int)levels.size() - 1; k >= 0; k--){
+			c = Mk(levels[k], BDD_FALSE, c);
+		}
+		return c;
+	}
+
+	unsigned AndExists(unsigned f, unsigned g, unsigned cube){
+		if(!beginOp(f,g,cube)){
+			return BDD_ABORTED;
+		}
+		return endOp(AndExists_(f,g,cube));
+	}
+
+	unsigned Exists(unsigned f, unsigned cube){
+		return AndExists(f,BDD_TRUE,cube);
+	}
+
+	unsigned addRenaming(const std::vector<unsigned> &from, const std::vector<unsigned> &to){
+		/*
+		 * Registers the renaming from[k] -> to[k] (variable numbers) and returns its
+		 * id, to be passed to Replace(). Variables not listed are left untouched.
+		 */
+		std::vector<unsigned> map(numVars + 1);
+		for(unsigned id = 0; id <= numVars; id++){
+			map[id] = id;
+		}
+		for(unsigned k = 0; k < from.size() && k < to.size(); k++){
+			map[from[k]] = to[k];
+		}
+		varMaps.push_back(map);
+		return varMaps.size() - 1;
+	}
+
+	unsigned Replace(unsigned u, unsigned mapId){
+		if(!beginOp(u)){
+			return BDD_ABORTED;
+		}
+		return endOp(Replace_(u,mapId));
+	}
+
+	unsigned Simplify(unsigned f, unsigned care){
+		/*
+		 * Returns a function that agrees with f wherever care is true and is usually
+		 * smaller than f (the restrict operator of Coudert and Madre).
+		 */
+		if(!beginOp(f,care)){
+			return BDD_ABORTED;
+		}
+		return endOp(Simplify_(f,care));
+	}
+
+	std::vector<unsigned> support(unsigned u){
+		/*
+		 * Returns the variable numbers u depends on, sorted by level.
+		 */
+		std::vector<bool> seen(T.size(), false), inSupport(numVars, false);
+		std::vector<unsigned> stack(1,u), vars;
+		if(u == BDD_ABORTED){
+			return vars;
+		}
+		while(!stack.empty()){
+			unsigned v = stack.back();
+			stack.pop_back();
+			if(T[v].level == numVars || seen[v]){
+				continue;
+			}
+			seen[v] = true;
+			inSupport[T[v].level] = true;
+			stack.push_back(T[v].low);
+			stack.push_back(T[v].high);
+		}
+		for(unsigned i = 0; i < numVars; i++){
+			if(inSupport[i]){
+				vars.push_back(order[i]);
+			}
+		}
+		return vars;
+	}
+
+	unsigned build(abSyntaxTree *node, bool *varBase){
+		/*
+		 * Builds the ROBDD of an abstract syntax tree produced by a parser. varBase is the
+		 * variables array of that parser, used to recover the variable number of a var node.
+		 */
+		if(node == NULL){
+			printf("Incorrect abstract syntax Tree");
+			fflush(stdout);
+			return BDD_FALSE;
+		}
+		beginOp(BDD_FALSE);
+		return endOp(build_(node, varBase));
+	}
+
+	double SatCount(unsigned u){
+		/*
+		 * Number of assignments to all numVars variables that satisfy u, -1 if u
+		 * is BDD_ABORTED.
+		 */
+		if(u == BDD_ABORTED){
+			return -1;
+		}
+		std::vector<double> memo(T.size(), -1);
+		return pow(2, T[u].level)*count(u,memo);
+	}
+
+	bool AnySat(unsigned u, std::vector<int> &assignment){
+		/*
+		 * Finds an assignment that satisfies u. The assignment is indexed by variable
+		 * number, variables that do not lie on the chosen path are set to -1 (don't care).
+		 * Returns false if u is unsatisfiable or BDD_ABORTED.
+		 */
+		assignment.assign(numVars + 1, -1);
+		if(u == BDD_FALSE || u == BDD_ABORTED){
+			return false;
+		}
+		while(u > BDD_TRUE){
+			if(T[u].low == BDD_FALSE){
+				assignment[order[T[u].level]] = 1;
+				u = T[u].high;
+			}
+			else{
+				assignment[order[T[u].level]] = 0;
+				u = T[u].low;
+			}
+		}
+		return true;
+	}
+
+	unsigned SampleSat(unsigned u, unsigned k, std::mt19937_64 &rng, std::vector<unsigned long long> &buffer){
+		/*
+		 * Draws k satisfying assignments of u uniformly at random (with replacement).
+		 * The samples are packed 64 per block like the patterns of simulator: block b
+		 * holds numVars+1 words starting at buffer[b*(numVars+1)], indexed by variable
+		 * number, and bit j of a word is the value of the variable in sample 64*b+j.
+		 * A block can thus be handed to simulator::simulate() as is. Bits of the last
+		 * block beyond k are random. Returns the number of blocks, 0 if u is
+		 * unsatisfiable or BDD_ABORTED.
+		 *
+		 * A path is drawn by taking the high edge of node v with probability
+		 * |high(v)| / |v|, |v| being the number of models of v over the levels below
+		 * it (memoized by count()), so every model is equally likely. Variables off
+		 * the path are don't cares and keep uniformly random bits, hence a sample
+		 * costs O(depth) after one pass over the nodes of u.
+		 */
+		unsigned words = numVars + 1, blocks = (k + 63) / 64, v;
+		std::vector<double> memo(T.size(), -1);
+		std::vector<double> pHigh;
+		unsigned long long bit;
+
+		buffer.clear();
+		if(u == BDD_FALSE || u == BDD_ABORTED){
+			return 0;
+		}
+		count(u, memo);
+		pHigh.assign(T.size(), 0);
+		for(v = 0; v < T.size(); v++){
+			if(memo[v] > 0 && T[v].level < numVars){
+				unsigned h = T[v].high;
+				pHigh[v] = pow(2, T[h].level - T[v].level - 1)*(h <= BDD_TRUE ? h : memo[h]) / memo[v];
+			}
+		}
+		buffer.resize((size_t)blocks*words);
+		for(size_t w = 0; w < buffer.size(); w++){
+			buffer[w] = rng();
+		}
+		for(unsigned j = 0; j < k; j++){
+			unsigned long long *block = &buffer[(size_t)(j / 64)*words];
+			bit = 1ULL << (j % 64);
+			for(v = u; v > BDD_TRUE; ){
+				unsigned id = order[T[v].level];
+				if((rng() >> 11) * 0x1.0p-53 < pHigh[v]){
+					block[id] |= bit;
+					v = T[v].high;
+				}
+				else{
+					block[id] &= ~bit;
+					v = T[v].low;
+				}
+			}
+		}
+		return blocks;
+	}
+
+	bool RandomSat(unsigned u, std::mt19937_64 &rng, std::vector<int> &assignment){
+		/*
+		 * Same as AnySat() but the assignment is drawn uniformly from the models of u,
+		 * with every variable assigned (0 or 1). Use SampleSat() for many samples, it
+		 * counts the models once for the whole batch.
+		 */
+		std::vector<unsigned long long> buffer;
+		assignment.assign(numVars + 1, -1);
+		if(SampleSat(u, 1, rng, buffer) == 0){
+			return false;
+		}
+		for(unsigned id = 1; id <= numVars; id++){
+			assignment[id] = buffer[id] & 1;
+		}
+		return true;
+	}
+
+	double MinCostSat(unsigned u, const std::vector<double> &cost0, const std::vector<double> &cost1,
+					  std::vector<int> &assignment){
+		/*
+		 * Finds the satisfying assignment of u with the smallest total cost, where
+		 * cost0[id]/cost1[id] is the cost of setting x(id) to 0/1 (both indexed by
+		 * variable number). This is a shortest path from u to terminal 1, computed
+		 * with one memoized pass over the nodes of u. Variables u does not depend on
+		 * are set to their cheaper value. Returns the cost, INFINITY if u is unsatisfiable
+		 * or BDD_ABORTED.
+		 */
+		std::vector<double> c0(numVars), c1(numVars), skip(numVars + 1, 0), memo(T.size(), -1);
+		unsigned l, h, i;
+		double best;
+
+		if(u == BDD_ABORTED){
+			u = BDD_FALSE;
+		}
+
+		for(i = 0; i < numVars; i++){
+			c0[i] = cost0[order[i]];
+			c1[i] = cost1[order[i]];
+			skip[i+1] = skip[i] + std::min(c0[i], c1[i]);
+		}
+		assignment.assign(numVars + 1, -1);
+		best = skip[T[u].level] + minCost(u,c0,c1,skip,memo);
+		if(u == BDD_FALSE){
+			return best;
+		}
+		for(i = 0; i < numVars; i++){
+			assignment[order[i]] = (c1[i] < c0[i]) ? 1 : 0;
+		}
+		while(u > BDD_TRUE){
+			i = T[u].level; l = T[u].low; h = T[u].high;
+			if(c0[i] + skip[T[l].level] - skip[i+1] + minCost(l,c0,c1,skip,memo) <=
+			   c1[i] + skip[T[h].level] - skip[i+1] + minCost(h,c0,c1,skip,memo)){
+				assignment[order[i]] = 0;
+				u = l;
+			}
+			else{
+				assignment[order[i]] = 1;
+				u = h;
+			}
+		}
+		return best;
+	}
+
+	double Probability(unsigned u, const std::vector<double> &prob){
+		/*
+		 * Weighted model count of u: the probability that u is true when x(id) is
+		 * true with probability prob[id] (indexed by variable number). With every
+		 * probability at 0.5 this is SatCount(u) / 2^numVars, -1 if u is BDD_ABORTED.
+		 */
+		if(u == BDD_ABORTED){
+			return -1;
+		}
+		std::vector<double> p(numVars), memo(T.size(), -1);
+		for(unsigned i = 0; i < numVars; i++){
+			p[i] = prob[order[i]];
+		}
+		return probability(u,p,memo);
+	}
+
+	unsigned size(unsigned u){
+		/*
+		 * Number of nodes (terminals included) reachable from u.
+		 */
+		std::vector<bool> seen(T.size(), false);
+		std::vector<unsigned> stack(1,u);
+		unsigned n = 0;
+		if(u == BDD_ABORTED){
+			return 0;
+		}
+		while(!stack.empty()){
+			unsigned v = stack.back();
+			stack.pop_back();
+			if(seen[v]){
+				continue;
+			}
+			seen[v] = true;
+			n++;
+			if(T[v].level != numVars){
+				stack.push_back(T[v].low);
+				stack.push_back(T[v].high);
+			}
+		}
+		return n;
+	}
+};
+
+class zddManager : protected bddManager{
+
+	/*
+	 * Zero-suppressed decision diagrams (Minato). A ZDD represents a family of sets over
+	 * the variables instead of a boolean function: a path to terminal 1 is a set made of
+	 * the variables whose high edge is taken. Terminal 0 is the empty family and terminal 1
+	 * the family holding only the empty set.
+	 *
+	 * The node table T, the unique table H and the computed table G are inherited from
+	 * bddManager, only the reduction rule differs: Mk() removes nodes whose high edge
+	 * points to 0 instead of nodes whose edges are equal. Variables that do not occur in
+	 * any set of the family therefore need no nodes at all, which keeps ZDDs of sparse
+	 * families small.
+	 *
+	 * The boolean operations of bddManager are hidden since they do not apply to ZDDs.
+	 */
+
+	enum zddOp {OP_UNION = OP_LAST, OP_INTERSECT, OP_DIFF, OP_CHANGE, OP_ONSET, OP_OFFSET};
+
+	unsigned Union_(unsigned P, unsigned Q){
+		unsigned u;
+		if(P == BDD_FALSE || P == Q) return Q;
+		if(Q == BDD_FALSE) return P;
+		if(status != BDD_OK) return BDD_FALSE;
+		if(P > Q){
+			std::swap(P,Q);
+		}
+		if(cacheLookup(OP_UNION,P,Q,0,u)){
+			return u;
+		}
+		if(T[P].level > T[Q].level){
+			std::swap(P,Q);
+		}
+		if(T[P].level < T[Q].level){
+			u = Mk(T[P].level, Union_(T[P].low,Q), T[P].high);
+		}
+		else{
+			u = Mk(T[P].level, Union_(T[P].low,T[Q].low),
+									Union_(T[P].high,T[Q].high));
+		}
+		cacheInsert(OP_UNION,std::min(P,Q),std::max(P,Q),0,u);
+		return u;
+	}
+
+	unsigned Intersect_(unsigned P, unsigned Q){
+		unsigned u;
+		if(P == BDD_FALSE || Q == BDD_FALSE || status != BDD_OK) return BDD_FALSE;
+		if(P == Q) return P;
+		if(P > Q){
+			std::swap(P,Q);
+		}
+		if(cacheLookup(OP_INTERSECT,P,Q,0,u)){
+			return u;
+		}
+		if(T[P].level < T[Q].level){
+			u = Intersect_(T[P].low,Q);
+		}
+		else if(T[P].level > T[Q].level){
+			u = Intersect_(P,T[Q].low);
+		}
+		else{
+			u = Mk(T[P].level, Intersect_(T[P].low,T[Q].low),
+									Intersect_(T[P].high,T[Q].high));
+		}
+		cacheInsert(OP_INTERSECT,P,Q,0,u);
+		return u;
+	}
+
+	unsigned Diff_(unsigned P, unsigned Q){
+		unsigned u;
+		if(P == BDD_FALSE || P == Q || status != BDD_OK) return BDD_FALSE;
+		if(Q == BDD_FALSE) return P;
+		if(cacheLookup(OP_DIFF,P,Q,0,u)){
+			return u;
+		}
+		if(T[P].level < T[Q].level){
+			u = Mk(T[P].level, Diff_(T[P].low,Q), T[P].high);
+		}
+		else if(T[P].level > T[Q].level){
+			u = Diff_(P,T[Q].low);
+		}
+		else{
+			u = Mk(T[P].level, Diff_(T[P].low,T[Q].low),
+									Diff_(T[P].high,T[Q].high));
+		}
+		cacheInsert(OP_DIFF,P,Q,0,u);
+		return u;
+	}
+
+	unsigned Cofactor_(unsigned op, unsigned P, unsigned i){
+		/*
+		 * Recursive operation of Change(), OnSet() and OffSet() on level i.
+		 */
+		unsigned u;
+		if(status != BDD_OK){
+			return BDD_FALSE;
+		}
+		if(T[P].level > i){
+			// no set of P contains the variable
+			switch(op){
+				case OP_CHANGE: return Mk(i, BDD_FALSE, P);
+				case OP_ONSET:  return BDD_FALSE;
+				default:        return P;
+			}
+		}
+		if(T[P].level == i){
+			switch(op){
+				case OP_CHANGE: return Mk(i, T[P].high, T[P].low);
+				case OP_ONSET:  return T[P].high;
+				default:        return T[P].low;
+			}
+		}
+		if(cacheLookup(op,P,i,0,u)){
+			return u;
+		}
+		u = Mk(T[P].level, Cofactor_(op,T[P].low,i), Cofactor_(op,T[P].high,i));
+		cacheInsert(op,P,i,0,u);
+		return u;
+	}
+
+	double count(unsigned P, std::vector<double> &memo){
+		if(P <= BDD_TRUE){
+			return P;
+		}
+		if(memo[P] < 0){
+			memo[P] = count(T[P].low,memo) + count(T[P].high,memo);
+		}
+		return memo[P];
+	}
+
+public:
+	using bddManager::setOrder;
+	using bddManager::read_index;
+	using bddManager::read_numVars;
+	using bddManager::size;
+	using bddManager::setLimits;
+	using bddManager::setOperationLimits;
+	using bddManager::read_status;
+	using bddManager::clearStatus;
+	using bddManager::liveNodes;
+	using bddManager::memoryBytes;
+	using bddManager::ref;
+	using bddManager::deref;
+	using bddManager::gc;
+
+	zddManager(unsigned max_size) : bddManager(max_size){}
+
+	unsigned Mk(unsigned i, unsigned l, unsigned h){
+		/*
+		 * The zero-suppressed Mk: a node whose high edge points to 0 is dropped.
+		 */
+		if(l == BDD_ABORTED || h == BDD_ABORTED){
+			return BDD_ABORTED;
+		}
+		if(h == BDD_FALSE){
+			return l;
+		}
+		return findOrAdd(i,l,h);
+	}
+
+	unsigned Empty(){
+		// the empty family
+		return BDD_FALSE;
+	}
+
+	unsigned Base(){
+		// the family holding only the empty set
+		return BDD_TRUE;
+	}
+
+	unsigned Single(unsigned id){
+		// the family {{x(id)}}
+		return Mk(levelOf[id], BDD_FALSE, BDD_TRUE);
+	}
+
+	unsigned Union(unsigned P, unsigned Q){
+		if(!beginOp(P,Q)){
+			return BDD_ABORTED;
+		}
+		return endOp(Union_(P,Q));
+	}
+
+	unsigned Intersect(unsigned P, unsigned Q){
+		if(!beginOp(P,Q)){
+			return BDD_ABORTED;
+		}
+		return endOp(Intersect_(P,Q));
+	}
+
+	unsigned Diff(unsigned P, unsigned Q){
+		if(!beginOp(P,Q)){
+			return BDD_ABORTED;
+		}
+		return endOp(Diff_(P,Q));
+	}
+
+	unsigned Change(unsigned P, unsigned id){
+		/*
+		 * Toggles x(id) in every set of P.
+		 */
+		if(!beginOp(P)){
+			return BDD_ABORTED;
+		}
+		return endOp(Cofactor_(OP_CHANGE,P,levelOf[id]));
+	}
+
+	unsigned OnSet(unsigned P, unsigned id){
+		/*
+		 * The sets of P that contain x(id), with x(id) removed.
+		 */
+		if(!beginOp(P)){
+			return BDD_ABORTED;
+		}
+		return endOp(Cofactor_(OP_ONSET,P,levelOf[id]));
+	}
+
+	unsigned OffSet(unsigned P, unsigned id){
+		/*
+		 * The sets of P that do not contain x(id).
+		 */
+		if(!beginOp(P)){
+			return BDD_ABORTED;
+		}
+		return endOp(Cofactor_(OP_OFFSET,P,levelOf[id]));
+	}
+
+	double Count(unsigned P){
+		/*
+		 * Number of sets in the family P, -1 if P is BDD_ABORTED.
+		 */
+		if(P == BDD_ABORTED){
+			return -1;
+		}
+		std::vector<double> memo(T.size(), -1);
+		return count(P,memo);
+	}
+
+	bool AnySet(unsigned P, std::vector<unsigned> &set){
+		/*
+		 * Returns one set of P (as variable numbers), false if P is empty or BDD_ABORTED.
+		 */
+		set.clear();
+		if(P == BDD_FALSE || P == BDD_ABORTED){
+			return false;
+		}
+		while(P > BDD_TRUE){
+			if(T[P].low != BDD_FALSE){
+				P = T[P].low;
+			}
+			else{
+				set.push_back(order[T[P].level]);
+				P = T[P].high;
+			}
+		}
+		return true;
+	}
+};
+
+class addManager : public bddManager{
+
+	/*
+	 * Algebraic decision diagrams (multi-terminal BDDs): decision diagrams whose terminals
+	 * carry numbers instead of 0/1, used to represent word-level functions such as the
+	 * value of a bit-vector or the product of two operands.
+	 *
+	 * ADDs live in the node table of bddManager. A terminal is a node on level numVars
+	 * whose low/high fields hold the index of its value, nodes 0 and 1 being the terminals
+	 * with values 0 and 1. A BDD built by the manager is therefore also the ADD of its
+	 * 0/1 function, so the boolean operations apply to such ADDs unchanged and a BDD is
+	 * converted to an ADD for free. Threshold() converts back from an ADD to a BDD.
+	 * The boolean operations must not be given ADDs with other terminals.
+	 */
+
+	enum addOp {OP_PLUS = OP_LAST, OP_TIMES, OP_MAX, OP_MIN, OP_THRESHOLD};
+
+	std::vector<double> values;				// value of each terminal, indexed by T[u].low
+	std::map<double, unsigned> terminals;	// value -> terminal node
+
+	double arith(unsigned op, double v1, double v2){
+		/*
+		 * Called by ApplyArith_() to operate on terminal nodes.
+		 */
+		switch(op){
+			case OP_PLUS:      return v1 + v2;
+			case OP_TIMES:     return v1 * v2;
+			case OP_MAX:       return std::max(v1,v2);
+			case OP_MIN:       return std::min(v1,v2);
+			case OP_THRESHOLD: return (v1 >= v2) ? 1 : 0;
+			default:
+				printf("\nINVALID OPERATOR. %d", op);
+				exit(0);
+		}
+	}
+
+	unsigned ApplyArith_(unsigned op, unsigned u1, unsigned u2){
+		unsigned u, i, l1, h1, l2, h2;
+		if(isTerminal(u1) && isTerminal(u2)){
+			return Constant(arith(op, value(u1), value(u2)));
+		}
+		if(status != BDD_OK){
+			return BDD_FALSE;
+		}
+		if(op == OP_TIMES && (u1 == BDD_FALSE || u2 == BDD_FALSE)) return BDD_FALSE;
+		if(op == OP_TIMES && u1 == BDD_TRUE) return u2;
+		if(op == OP_TIMES && u2 == BDD_TRUE) return u1;
+		if(op == OP_PLUS && u1 == BDD_FALSE) return u2;
+		if(op == OP_PLUS && u2 == BDD_FALSE) return u1;
+		if((op == OP_MAX || op == OP_MIN) && u1 == u2) return u1;
+		if(op != OP_THRESHOLD && u1 > u2){
+			std::swap(u1,u2);
+		}
+		if(cacheLookup(op,u1,u2,0,u)){
+			return u;
+		}
+		i = std::min(T[u1].level, T[u2].level);
+		l1 = h1 = u1;
+		l2 = h2 = u2;
+		if(T[u1].level == i){
+			l1 = T[u1].low; h1 = T[u1].high;
+		}
+		if(T[u2].level == i){
+			l2 = T[u2].low; h2 = T[u2].high;
+		}
+		u = Mk(i, ApplyArith_(op,l1,l2), ApplyArith_(op,h1,h2));
+		cacheInsert(op,u1,u2,0,u);
+		return u;
+	}
+
+	unsigned import_(bddManager &src, unsigned u, std::map<unsigned,unsigned> &done){
+		unsigned r;
+		if(u <= BDD_TRUE){
+			return u;
+		}
+		if(status != BDD_OK){
+			return BDD_FALSE;
+		}
+		std::map<unsigned,unsigned>::iterator it = done.find(u);
+		if(it != done.end()){
+			return it->second;
+		}
+		unsigned v = ithVar(src.varAt(src.level(u)));
+		unsigned l = import_(src, src.low(u), done), h = import_(src, src.high(u), done);
+		r = Apply(OR, Apply(AND, v, h), Apply(AND, Not(v), l));
+		done[u] = r;
+		return r;
+	}
+
+public:
+
+	addManager(unsigned max_size) : bddManager(max_size){
+		values.push_back(0);
+		values.push_back(1);
+		terminals[0] = BDD_FALSE;
+		terminals[1] = BDD_TRUE;
+	}
+
+	bool isTerminal(unsigned u){
+		return T[u].level == numVars;
+	}
+
+	double value(unsigned u){
+		return values[T[u].low];
+	}
+
+	unsigned Constant(double v){
+		/*
+		 * Returns the terminal with value v, creating it if needed. Terminals are not
+		 * kept in the per-level subtables, they are found through terminals instead.
+		 */
+		std::map<double,unsigned>::iterator it = terminals.find(v);
+		if(it != terminals.end()){
+			return it->second;
+		}
+		unsigned u = T.size(), k = values.size();
+		values.push_back(v);
+		T.push_back({numVars,k,k,0});
+		terminals[v] = u;
+		return u;
+	}
+
+	unsigned Plus(unsigned u1, unsigned u2){
+		if(!beginOp(u1,u2)){
+			return BDD_ABORTED;
+		}
+		return endOp(ApplyArith_(OP_PLUS,u1,u2));
+	}
+
+	unsigned Times(unsigned u1, unsigned u2){
+		if(!beginOp(u1,u2)){
+			return BDD_ABORTED;
+		}
+		return endOp(ApplyArith_(OP_TIMES,u1,u2));
+	}
+
+	unsigned Max(unsigned u1, unsigned u2){
+		if(!beginOp(u1,u2)){
+			return BDD_ABORTED;
+		}
+		return endOp(ApplyArith_(OP_MAX,u1,u2));
+	}
+
+	unsigned Min(unsigned u1, unsigned u2){
+		if(!beginOp(u1,u2)){
+			return BDD_ABORTED;
+		}
+		return endOp(ApplyArith_(OP_MIN,u1,u2));
+	}
+
+	unsigned Threshold(unsigned u, double t){
+		/*
+		 * Returns the BDD of (u >= t).
+		 */
+		if(!beginOp(u)){
+			return BDD_ABORTED;
+		}
+		return endOp(ApplyArith_(OP_THRESHOLD,u,Constant(t)));
+	}
+
+	unsigned fromBDD(bddManager &src, unsigned u){
+		/*
+		 * Copies a BDD of another manager into this one (variables are matched by
+		 * number). BDDs of this manager need no conversion.
+		 */
+		std::map<unsigned,unsigned> done;
+		if(!beginOp(u)){
+			return BDD_ABORTED;
+		}
+		return endOp(import_(src, u, done));
+	}
+
+	unsigned fromBits(const std::vector<unsigned> &bits, bool sign){
+		/*
+		 * Returns the ADD of the integer value of a bit-vector (LSB first) of this
+		 * manager, in two's complement if sign is set.
+		 */
+		unsigned r = Constant(0);
+		double weight = 1;
+		for(unsigned k = 0; k < bits.size(); k++){
+			if(sign && k + 1 == bits.size()){
+				weight = -weight;
+			}
+			r = Plus(r, Times(bits[k], Constant(weight)));
+			weight = fabs(weight)*2;
+		}
+		return r;
+	}
+
+	unsigned terminalCount(unsigned u){
+		/*
+		 * Number of distinct values u takes.
+		 */
+		std::vector<bool> seen(T.size(), false);
+		std::vector<unsigned> stack(1,u);
+		unsigned n = 0;
+		if(u == BDD_ABORTED){
+			return 0;
+		}
+		while(!stack.empty()){
+			unsigned v = stack.back();
+			stack.pop_back();
+			if(seen[v]){
+				continue;
+			}
+			seen[v] = true;
+			if(isTerminal(v)){
+				n++;
+			}
+			else{
+				stack.push_back(T[v].low);
+				stack.push_back(T[v].high);
+			}
+		}
+		return n;
+	}
+};
+
+class simulator{
+	/*
+	 * Bit-parallel version of the evaluator. Every variable is assigned a 64-bit word
+	 * instead of a bool, bit k of the word being the value of the variable in the k-th
+	 * input pattern. A single traversal of the abstract syntax tree then evaluates the
+	 * expression for 64 input patterns at once.
+	 */
+	bool *variables;
+	const unsigned long long *patterns;
+
+	unsigned long long simSubTree(abSyntaxTree *node){
+		unsigned long long v1, v2;
+		switch(node->type){
+			case T:   return ~0ULL;
+			case F:   return 0ULL;
+			case var: return patterns[(node->data - variables) + 1];
+			case NOT: return ~simSubTree(node->lptr);
+		}
+		v1 = simSubTree(node->lptr);
+		v2 = simSubTree(node->rptr);
+		switch(node->type){
+			case OR:    return (v1 | v2);
+			case AND:   return (v1 & v2);
+			case IMPL:  return (~v1 | v2);
+			case EQUIV: return ~(v1 ^ v2);
+			case XOR:   return (v1 ^ v2);
+		}
+		return 0ULL;
+	}
+
+public:
+	unsigned long long simulate(abSyntaxTree *node, bool *varBase, const unsigned long long *words){
+		/*
+		 * words is indexed by variable number (words[0] is unused) and varBase is the
+		 * variables array of the parser that produced the tree.
+		 */
+		if(node == NULL){
+			return 0ULL;
+		}
+		variables = varBase;
+		patterns = words;
+		return simSubTree(node);
+	}
+};
+
+class bddDiskCache{
+	/*
+	 * Persistent cache of built ROBDDs, shared by all runs that use the same cache
+	 * directory. An entry is keyed by a canonical form of the abstract syntax tree,
+	 * in which variables are renamed v1, v2, ... in order of first occurrence, and by
+	 * the relative order of those variables in the manager. Formulas that only differ
+	 * in the names of their variables therefore share an entry, as long as their
+	 * variables appear in the same relative order.
+	 *
+	 * Each entry is one file named after a 64-bit hash of the key. The file starts with
+	 * the key itself (to rule out hash collisions) followed by the nodes of the ROBDD
+	 * in post-order, with variables given by their canonical number. The modification
+	 * time of a file (to the nanosecond) is its last use: hits touch the file, and when
+	 * the directory grows beyond maxBytes the least recently used entries are deleted.
+	 * The size of the directory is counted once when the cache is opened and then kept
+	 * up to date by store(), so the directory is only scanned again to evict.
+	 */
+	std::string dir;
+	unsigned long long maxBytes;
+	unsigned long long totalBytes;		// size of the entries, as far as this process knows
+
+	void canonical(abSyntaxTree *node, bool *varBase, std::vector<unsigned> &rename,
+				   std::vector<unsigned> &vars, std::string &key){
+		/*
+		 * Appends the canonical prefix form of the sub-tree to key. rename maps a
+		 * variable number to its canonical number (0 => not seen yet) and vars lists
+		 * the variable numbers in canonical order.
+		 */
+		static const char *names[] = {"NOT", "AND", "OR", "IMPL", "EQUIV", "XOR"};
+		unsigned id;
+		switch(node->type){
+			case T: key += "T"; return;
+			case F: key += "F"; return;
+			case var:
+				id = (unsigned)(node->data - varBase) + 1;
+				if(id >= rename.size()){
+					rename.resize(id + 1, 0);
+				}
+				if(rename[id] == 0){
+					vars.push_back(id);
+					rename[id] = vars.size();
+				}
+				key += "v" + std::to_string(rename[id]);
+				return;
+		}
+		key += "(";
+		key += names[node->type];
+		key += " ";
+		canonical(node->lptr, varBase, rename, vars, key);
+		if(node->type != NOT){
+			key += " ";
+			canonical(node->rptr, varBase, rename, vars, key);
+		}
+		key += ")";
+	}
+
+	std::string makeKey(bddManager &m, abSyntaxTree *node, bool *varBase, std::vector<unsigned> &vars){
+		/*
+		 * Canonical formula followed by the canonical variables sorted by level.
+		 */
+		std::vector<unsigned> rename, ranks;
+		std::string key;
+		canonical(node, varBase, rename, vars, key);
+		for(unsigned k = 0; k < vars.size(); k++){
+			ranks.push_back(k);
+		}
+		std::sort(ranks.begin(), ranks.end(), [&](unsigned a, unsigned b){
+			return m.levelOfVar(vars[a]) < m.levelOfVar(vars[b]);
+		});
+		key += " |";
+		for(unsigned k = 0; k < ranks.size(); k++){
+			key += " " + std::to_string(ranks[k] + 1);
+		}
+		return key;
+	}
+
+	std::string path(const std::string &key){
+		/*
+		 * File of an entry, named after the FNV-1a hash of its key.
+		 */
+		unsigned long long h = 14695981039346656037ULL;
+		char name[32];
+		for(unsigned k = 0; k < key.size(); k++){
+			h = (h ^ (unsigned char)key[k]) * 1099511628211ULL;
+		}
+		snprintf(name, sizeof(name), "/%016llx.bdd", h);
+		return dir + name;
+	}
+
+	struct entry{
+		long long sec, nsec;			// last use
+		std::string name;
+		unsigned long long bytes;
+	};
+
+	unsigned long long scan(std::vector<entry> &files){
+		/*
+		 * Lists the entries of the directory, returns their total size.
+		 */
+		unsigned long long total = 0;
+		struct dirent *ent;
+		struct stat st;
+		DIR *d = opendir(dir.c_str());
+		if(d == NULL){
+			return 0;
+		}
+		while((ent = readdir(d)) != NULL){
+			std::string name = ent->d_name;
+			if(name.size() < 4 || name.compare(name.size() - 4, 4, ".bdd") != 0){
+				continue;
+			}
+			name = dir + "/" + name;
+			if(stat(name.c_str(), &st) == 0){
+				files.push_back({(long long)st.st_mtim.tv_sec, (long long)st.st_mtim.tv_nsec, name,
+								 (unsigned long long)st.st_size});
+				total += st.st_size;
+			}
+		}
+		closedir(d);
+		return total;
+	}
+
+	void evict(){
+		/*
+		 * Deletes the least recently used entries until the cache fits in maxBytes.
+		 * The directory is scanned again first, since other runs may share it.
+		 */
+		std::vector<entry> files;
+		totalBytes = scan(files);
+		std::sort(files.begin(), files.end(), [](const entry &a, const entry &b){
+			return a.sec != b.sec ? a.sec < b.sec : a.nsec < b.nsec;
+		});
+		for(unsigned k = 0; k < files.size() && totalBytes > maxBytes; k++){
+			if(remove(files[k].name.c_str()) == 0){
+				totalBytes -= files[k].bytes;
+			}
+		}
+	}
+
+	bool load(bddManager &m, const std::string &key, std::vector<unsigned> &vars, unsigned &root){
+		/*
+		 * Reads the ROBDD of key into m. Files that do not hold a well formed ROBDD for
+		 * the current variable order (a child that is not strictly below its parent, a
+		 * reference to a later node) are rejected, so a corrupt entry is a miss.
+		 */
+		std::string file = path(key);
+		FILE *fi = fopen(file.c_str(), "rb");
+		unsigned long long keyLen = 0;
+		unsigned count = 0, node[3], lvl;
+		std::vector<unsigned> local;
+		std::string stored;
+
+		if(fi == NULL){
+			return false;
+		}
+		if(fread(&keyLen, sizeof(keyLen), 1, fi) != 1 || keyLen != key.size()){
+			fclose(fi);
+			return false;
+		}
+		stored.resize(keyLen);
+		if(fread(&stored[0], 1, keyLen, fi) != keyLen || stored != key ||
+		   fread(&count, sizeof(count), 1, fi) != 1 || count == 0){
+			fclose(fi);
+			return false;
+		}
+		local.push_back(BDD_FALSE);
+		local.push_back(BDD_TRUE);
+		for(unsigned k = 0; k < count; k++){
+			if(fread(node, sizeof(unsigned), 3, fi) != 3){
+				fclose(fi);
+				return false;
+			}
+			if(count == 1 && node[1] == node[2] && node[1] <= BDD_TRUE){
+				// a constant (see store()), which may have no variables at all
+				local.push_back(node[1]);
+				break;
+			}
+			if(node[0] == 0 || node[0] > vars.size() || node[1] >= local.size() || node[2] >= local.size()){
+				fclose(fi);
+				return false;
+			}
+			lvl = m.levelOfVar(vars[node[0]-1]);
+			if(m.level(local[node[1]]) <= lvl || m.level(local[node[2]]) <= lvl){
+				fclose(fi);
+				return false;
+			}
+			local.push_back(m.Mk(lvl, local[node[1]], local[node[2]]));
+		}
+		fclose(fi);
+		root = local.back();
+		utimensat(AT_FDCWD, file.c_str(), NULL, 0);		// mark as most recently used
+		return true;
+	}
+
+	void store(bddManager &m, const std::string &key, std::vector<unsigned> &vars, unsigned root){
+		/*
+		 * Writes the nodes reachable from root in post-order, children before parents,
+		 * to a temporary file that is renamed into place only if it was written whole.
+		 */
+		std::map<unsigned, unsigned> rename, local;
+		std::vector<unsigned> nodes, stack(1, root);
+		std::string file = path(key), tmp;
+		unsigned long long keyLen = key.size();
+		unsigned count, node[3];
+		struct stat st;
+		bool written;
+		FILE *fo;
+
+		for(unsigned k = 0; k < vars.size(); k++){
+			rename[vars[k]] = k + 1;
+		}
+		local[BDD_FALSE] = 0;
+		local[BDD_TRUE] = 1;
+		while(!stack.empty()){
+			unsigned u = stack.back();
+			if(local.count(u)){
+				stack.pop_back();
+			}
+			else if(local.count(m.low(u)) && local.count(m.high(u))){
+				stack.pop_back();
+				local[u] = nodes.size() + 2;
+				nodes.push_back(u);
+			}
+			else{
+				stack.push_back(m.low(u));
+				stack.push_back(m.high(u));
+			}
+		}
+		if(nodes.empty()){
+			// a constant is stored as a single node whose edges both point to it
+			node[0] = 1; node[1] = node[2] = root;
+		}
+		tmp = file + ".tmp";
+		fo = fopen(tmp.c_str(), "wb");
+		if(fo == NULL){
+			return;
+		}
+		count = nodes.empty() ? 1 : nodes.size();
+		written = fwrite(&keyLen, sizeof(keyLen), 1, fo) == 1;
+		written = written && fwrite(key.data(), 1, keyLen, fo) == keyLen;
+		written = written && fwrite(&count, sizeof(count), 1, fo) == 1;
+		if(nodes.empty()){
+			written = written && fwrite(node, sizeof(unsigned), 3, fo) == 3;
+		}
+		for(unsigned k = 0; k < nodes.size() && written; k++){
+			node[0] = rename[m.varAt(m.level(nodes[k]))];
+			node[1] = local[m.low(nodes[k])];
+			node[2] = local[m.high(nodes[k])];
+			written = fwrite(node, sizeof(unsigned), 3, fo) == 3;
+		}
+		// a short write or a failed flush (e.g. a full disk) never replaces an entry
+		if(fclose(fo) != 0 || !written){
+			unlink(tmp.c_str());
+			return;
+		}
+		if(stat(file.c_str(), &st) == 0){
+			totalBytes -= std::min(totalBytes, (unsigned long long)st.st_size);
+		}
+		// rename() is atomic, so concurrent runs never see half written entries
+		if(rename_file(tmp, file) && stat(file.c_str(), &st) == 0){
+			totalBytes += st.st_size;
+		}
+		if(totalBytes > maxBytes){
+			evict();
+		}
+	}
+
+	bool rename_file(const std::string &from, const std::string &to){
+		if(::rename(from.c_str(), to.c_str()) != 0){
+			remove(from.c_str());
+			return false;
+		}
+		return true;
+	}
+
+public:
+	unsigned long long hits, misses;
+
+	bddDiskCache(const char *directory, unsigned long long max_bytes){
+		dir = directory;
+		maxBytes = max_bytes;
+		hits = misses = 0;
+		mkdir(directory, 0755);
+		std::vector<entry> files;
+		totalBytes = scan(files);
+	}
+
+	unsigned build(bddManager &m, abSyntaxTree *node, bool *varBase){
+		/*
+		 * Returns the ROBDD of the tree, loading it from the cache if present and
+		 * building (and storing) it otherwise.
+		 */
+		std::vector<unsigned> vars;
+		std::string key;
+		unsigned root;
+		if(node == NULL){
+			return m.build(node, varBase);
+		}
+		key = makeKey(m, node, varBase, vars);
+		if(load(m, key, vars, root)){
+			hits++;
+			return root;
+		}
+		misses++;
+		root = m.build(node, varBase);
+		if(root != BDD_ABORTED){
+			store(m, key, vars, root);
+		}
+		return root;
+	}
+};
+
+bddDiskCache* openDiskCache(){
+	/*
+	 * The persistent cache is enabled by setting ROBDD_CACHE_DIR. Its size cap is
+	 * CACHE_MAX_MB unless ROBDD_CACHE_MB says otherwise. Returns NULL if disabled.
+	 */
+	const char *dir = getenv("ROBDD_CACHE_DIR");
+	const char *mb = getenv("ROBDD_CACHE_MB");
+	if(dir == NULL || *dir == 0){
+		return NULL;
+	}
+	return new bddDiskCache(dir, (unsigned long long)(mb ? atoi(mb) : CACHE_MAX_MB) << 20);
+}
+
+bddLimits limitsFromEnv(){
+	/*
+	 * Global limits of the managers used by the command line modes, read from
+	 * ROBDD_MAX_NODES, ROBDD_MAX_MB and ROBDD_MAX_SECONDS (unset => no limit).
+	 */
+	const char *nodes = getenv("ROBDD_MAX_NODES");
+	const char *mb = getenv("ROBDD_MAX_MB");
+	const char *seconds = getenv("ROBDD_MAX_SECONDS");
+	bddLimits limits = {0, 0, 0};
+	if(nodes != NULL){
+		limits.maxNodes = strtoull(nodes, NULL, 10);
+	}
+	if(mb != NULL){
+		limits.maxBytes = strtoull(mb, NULL, 10) << 20;
+	}
+	if(seconds != NULL){
+		limits.maxSeconds = atof(seconds);
+	}
+	return limits;
+}
+
+struct equivResult{
+	/*
+	 * Outcome of an equivalence check. cex holds the distinguishing input, indexed by
+	 * variable number (-1 => don't care), if the two sides differ.
+	 */
+	bool equivalent;
+	bool bySimulation;		// true if the counterexample was found by random simulation
+	int output;				// index of the first output that differs
+	unsigned long long patterns;	// number of random patterns simulated
+	bddStatus status;		// BDD_OK unless building the ROBDDs hit a limit (undecided)
+	std::vector<int> cex;
+};
+
+equivResult equivalence(std::vector<abSyntaxTree*> &a, bool *baseA,
+						std::vector<abSyntaxTree*> &b, bool *baseB, unsigned numVars,
+						bddDiskCache *cache = NULL, bddLimits limits = {0, 0, 0}){
+	/*
+	 * Checks whether the outputs of two netlists (a single formula is a netlist with
+	 * one output) are pairwise equivalent.
+	 *
+	 * Random simulation is run first because it finds most counterexamples for a fraction
+	 * of the cost of building the ROBDDs. If simulation finds no difference, both sides are
+	 * built in one shared manager so equivalence is decided by comparing roots, and a
+	 * distinguishing input is derived from AnySat() on the XOR of the two roots.
+	 * If a persistent cache is given, previously built ROBDDs are loaded from it.
+	 * If the ROBDDs cannot be built within limits the check is left undecided.
+	 */
+	equivResult res;
+	simulator s;
+	std::mt19937_64 mt;		// default seed, so that runs are reproducible
+	std::vector<unsigned long long> words(numVars + 1, 0);
+	unsigned long long diff;
+	unsigned outputs = std::min(a.size(), b.size());
+	unsigned bit;
+
+	res.equivalent = true;
+	res.bySimulation = false;
+	res.output = -1;
+	res.patterns = 0;
+	res.status = BDD_OK;
+
+	for(unsigned w = 0; w < SIM_WORDS; w++){
+		for(unsigned id = 1; id <= numVars; id++){
+			words[id] = mt();
+		}
+		res.patterns += 64;
+		for(unsigned o = 0; o < outputs; o++){
+			diff = s.simulate(a[o], baseA, words.data()) ^ s.simulate(b[o], baseB, words.data());
+			if(diff != 0){
+				bit = __builtin_ctzll(diff);
+				res.equivalent = false;
+				res.bySimulation = true;
+				res.output = o;
+				res.cex.assign(numVars + 1, -1);
+				for(unsigned id = 1; id <= numVars; id++){
+					res.cex[id] = (words[id] >> bit) & 1;
+				}
+				return res;
+			}
+		}
+	}
+
+	bddManager m(numVars);
+	m.setLimits(limits);
+	for(unsigned o = 0; o < outputs; o++){
+		unsigned ra = cache ? cache->build(m, a[o], baseA) : m.build(a[o], baseA);
+		unsigned rb = (ra == BDD_ABORTED) ? BDD_ABORTED :
+					  cache ? cache->build(m, b[o], baseB) : m.build(b[o], baseB);
+		if(rb == BDD_ABORTED){
+			res.status = m.read_status();
+			res.output = o;
+			return res;
+		}
+		if(ra != rb){
+			res.equivalent = false;
+			res.output = o;
+			m.AnySat(m.Apply(XOR, ra, rb), res.cex);
+			return res;
+		}
+	}
+	return res;
+}
+
+unsigned readNetlist(const char *arg, parser &p, std::vector<abSyntaxTree*> &outputs){
+	/*
+	 * Reads one side of an equivalence check. If arg names a readable file it is read
+	 * as a netlist, one output formula per line (empty lines and lines starting with '#'
+	 * are skipped). Otherwise arg itself is parsed as a single formula.
+	 * Returns the largest variable number used, or 0 if a formula could not be parsed.
+	 */
+	char line[MAX_LINE_SIZE];
+	unsigned maxId = 0;
+	abSyntaxTree *exp;
+	FILE *fi = fopen(arg, "r");
+
+	if(fi == NULL){
+		strncpy(line, arg, MAX_LINE_SIZE - 1);
+		line[MAX_LINE_SIZE - 1] = 0;
+		exp = p.formulaWrapper(line);
+		if(exp == NULL){
+			return 0;
+		}
+		outputs.push_back(exp);
+		for(int k = 0; k < p.numVar; k++){
+			maxId = std::max(maxId, p.var_list[k]);
+		}
+		return std::max(maxId, 1u);
+	}
+	while(fgets(line, MAX_LINE_SIZE, fi) != NULL){
+		line[strcspn(line, "\r\n")] = 0;
+		if(line[0] == 0 || line[0] == '#'){
+			continue;
+		}
+		exp = p.formulaWrapper(line);
+		if(exp == NULL){
+			fclose(fi);
+			return 0;
+		}
+		outputs.push_back(exp);
+		for(int k = 0; k < p.numVar; k++){
+			maxId = std::max(maxId, p.var_list[k]);
+		}
+	}
+	fclose(fi);
+	return std::max(maxId, 1u);
+}
+
+void printEquivResult(equivResult &res, unsigned numVars){
+	if(res.status != BDD_OK){
+		printf("\nUNDECIDED: no difference in %llu random patterns, ROBDDs of output %d aborted (%s).",
+				res.patterns, res.output, statusName(res.status));
+		fflush(stdout);
+		return;
+	}
+	if(res.equivalent){
+		printf("\nEquivalent (%llu random patterns, all outputs match).", res.patterns);
+		fflush(stdout);
+		return;
+	}
+	printf("\nNOT equivalent: output %d differs (found by %s).\nDistinguishing input:",
+			res.output, res.bySimulation ? "random simulation" : "ROBDD comparison");
+	for(unsigned id = 1; id <= numVars && id < res.cex.size(); id++){
+		if(res.cex[id] != -1){
+			printf(" x%d=%d", id, res.cex[id]);
+		}
+	}
+	fflush(stdout);
+}
+
+class portfolio{
+	/*
+	 * Builds one formula concurrently under several variable orders, one thread and one
+	 * manager per order, since the best order of a formula is hard to predict. The
+	 * orders are the order of appearance (as in var_list), its reverse, a depth-first
+	 * order visiting the deeper operand first, an interleaving of the variables of the
+	 * two operands of the root, and random orders.
+	 *
+	 * When the first build finishes, the others are cancelled through the node bar of
+	 * their managers as soon as they hold more than factor times the nodes the winner
+	 * needed, or take more than factor times its time. Of the builds that finish, the
+	 * smallest ROBDD is kept.
+	 */
+public:
+	struct entry{
+		std::string name;
+		std::vector<unsigned> order;	// variable numbers, top level first
+		bddManager *m;
+		unsigned root;
+		unsigned size;
+		unsigned long long nodes;		// live nodes of the manager when the build ended
+		double seconds;
+		bddStatus status;
+	};
+
+private:
+	typedef std::chrono::steady_clock clk;
+	std::vector<entry> entries;
+	std::atomic<unsigned long long> bar;
+	std::atomic<int> first;				// entry that finished first, -1 => none yet
+	std::atomic<unsigned> done;			// builds that ended, finished or cancelled
+	std::mutex lock;
+	clk::time_point start;
+
+	static unsigned depth(abSyntaxTree *node, std::map<abSyntaxTree*, unsigned> &memo){
+		if(node == NULL || node->type == var || node->type == oprtr::T || node->type == oprtr::F){
+			return 0;
+		}
+		std::map<abSyntaxTree*, unsigned>::iterator it = memo.find(node);
+		if(it != memo.end()){
+			return it->second;
+		}
+		unsigned d = 1 + std::max(depth(node->lptr, memo), depth(node->rptr, memo));
+		memo[node] = d;
+		return d;
+	}
+
+	static void dfs(abSyntaxTree *node, bool *varBase, bool deeperFirst, std::map<abSyntaxTree*, unsigned> &memo,
+					std::vector<bool> &seen, std::vector<unsigned> &ids){
+		/*
+		 * Appends the variables of the sub-tree in depth-first order, skipping the
+		 * ones already seen.
+		 */
+		if(node == NULL){
+			return;
+		}
+		if(node->type == var){
+			unsigned id = (unsigned)(node->data - varBase) + 1;
+			if(!seen[id]){
+				seen[id] = true;
+				ids.push_back(id);
+			}
+			return;
+		}
+		abSyntaxTree *a = node->lptr, *b = node->rptr;
+		if(deeperFirst && depth(b, memo) > depth(a, memo)){
+			std::swap(a,b);
+		}
+		dfs(a, varBase, deeperFirst, memo, seen, ids);
+		dfs(b, varBase, deeperFirst, memo, seen, ids);
+	}
+
+	static std::vector<unsigned> complete(std::vector<unsigned> ids, unsigned numVars){
+		// appends the variables the formula does not use, so every order is total
+		std::vector<bool> seen(numVars + 1, false);
+		for(unsigned k = 0; k < ids.size(); k++){
+			seen[ids[k]] = true;
+		}
+		for(unsigned id = 1; id <= numVars; id++){
+			if(!seen[id]){
+				ids.push_back(id);
+			}
+		}
+		return ids;
+	}
+
+	void add(const char *name, const std::vector<unsigned> &order){
+		entry e;
+		e.name = name;
+		e.order = order;
+		e.m = NULL;
+		e.root = BDD_ABORTED;
+		e.size = 0;
+		e.nodes = 0;
+		e.seconds = 0;
+		e.status = BDD_OK;
+		entries.push_back(e);
+	}
+
+	void worker(unsigned k, abSyntaxTree *node, bool *varBase, unsigned numVars, double factor){
+		entry &e = entries[k];
+		e.m = new bddManager(numVars);
+		e.m->setOrder(e.order.data(), e.order.size());
+		e.m->setNodeBar(&bar);
+		e.root = e.m->build(node, varBase);
+		e.seconds = std::chrono::duration<double>(clk::now() - start).count();
+		e.nodes = e.m->liveNodes();
+		if(e.root == BDD_ABORTED){
+			e.status = e.m->read_status();
+		}
+		else{
+			e.size = e.m->size(e.root);
+			std::lock_guard<std::mutex> guard(lock);
+			if(first < 0){
+				bar = std::min(bar.load(), (unsigned long long)(factor * e.nodes));
+				first = k;
+			}
+		}
+		done++;
+	}
+
+public:
+	portfolio(){
+		first = -1;
+		done = 0;
+		bar = ~0ULL;
+	}
+
+	~portfolio(){
+		for(unsigned k = 0; k < entries.size(); k++){
+			delete entries[k].m;
+		}
+	}
+
+	const std::vector<entry>& results(){
+		return entries;
+	}
+
+	int run(abSyntaxTree *node, bool *varBase, unsigned numVars, unsigned k, double factor = 2){
+		/*
+		 * Builds node under k orders (the first k of the orders listed above, random
+		 * ones from the fifth on) and returns the index of the entry holding the smallest ROBDD,
+		 * -1 if every build was cancelled. The managers stay alive until the
+		 * portfolio is destroyed.
+		 */
+		std::map<abSyntaxTree*, unsigned> memo;
+		std::vector<bool> seen(numVars + 1, false);
+		std::vector<unsigned> ids, left, right;
+		std::vector<std::thread> threads;
+		std::mt19937 mt;		// default seed, so that runs are reproducible
+		int best = -1;
+
+		if(node == NULL){
+			return -1;
+		}
+		dfs(node, varBase, false, memo, seen, ids);
+		add("appearance", complete(ids, numVars));
+		std::reverse(ids.begin(), ids.end());
+		add("reversed", complete(ids, numVars));
+
+		ids.clear(); seen.assign(numVars + 1, false);
+		dfs(node, varBase, true, memo, seen, ids);
+		add("dfs-deepest", complete(ids, numVars));
+
+		seen.assign(numVars + 1, false);
+		dfs(node->lptr, varBase, false, memo, seen, left);
+		dfs(node->rptr, varBase, false, memo, seen, right);
+		ids.clear();
+		for(unsigned j = 0; j < left.size() || j < right.size(); j++){
+			if(j < left.size()) ids.push_back(left[j]);
+			if(j < right.size()) ids.push_back(right[j]);
+		}
+		add("interleaved", complete(ids, numVars));
+
+		while(entries.size() < k){
+			ids = complete(std::vector<unsigned>(), numVars);
+			std::shuffle(ids.begin(), ids.end(), mt);
+			add("random", ids);
+		}
+		entries.resize(std::min<size_t>(entries.size(), std::max(k, 1u)));
+
+		start = clk::now();
+		for(unsigned j = 0; j < entries.size(); j++){
+			threads.push_back(std::thread(&portfolio::worker, this, j, node, varBase, numVars, factor));
+		}
+		/*
+		 * The node bar cancels the losers that grow too large. Losers that stay small
+		 * but run too long are cancelled here by dropping the bar to 0.
+		 */
+		while(done < threads.size()){
+			if(first >= 0 && bar.load() > 0 &&
+			   std::chrono::duration<double>(clk::now() - start).count() > factor * entries[first].seconds){
+				bar = 0;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		for(unsigned j = 0; j < threads.size(); j++){
+			threads[j].join();
+			entries[j].m->setNodeBar(NULL);
+		}
+		for(unsigned j = 0; j < entries.size(); j++){
+			if(entries[j].root != BDD_ABORTED && (best < 0 || entries[j].size < entries[best].size)){
+				best = j;
+			}
+		}
+		return best;
+	}
+};
+
+class bitVector{
+	/*
+	 * Word-level helpers on top of a shared manager. A bit-vector is a vector of
+	 * ROBDD nodes, least significant bit first. Arithmetic wraps around at the width
+	 * of the first operand, like the (unsized) Verilog operators it models.
+	 */
+	bddManager &m;
+
+public:
+	typedef std::vector<unsigned> bvec;
+
+	bitVector(bddManager &mgr) : m(mgr){}
+
+	bvec vars(const std::vector<unsigned> &ids){
+		bvec r;
+		for(unsigned k = 0; k < ids.size(); k++){
+			r.push_back(m.ithVar(ids[k]));
+		}
+		return r;
+	}
+
+	bvec constant(unsigned width, unsigned long long value){
+		bvec r(width, BDD_FALSE);
+		for(unsigned k = 0; k < width && k < 64; k++){
+			r[k] = ((value >> k) & 1) ? BDD_TRUE : BDD_FALSE;
+		}
+		return r;
+	}
+
+	bvec slice(const bvec &a, unsigned hi, unsigned lo){
+		/*
+		 * a[hi:lo]
+		 */
+		return bvec(a.begin() + lo, a.begin() + hi + 1);
+	}
+
+	bvec concat(const bvec &hi, const bvec &lo){
+		/*
+		 * {hi, lo}
+		 */
+		bvec r(lo);
+		r.insert(r.end(), hi.begin(), hi.end());
+		return r;
+	}
+
+	bvec resize(const bvec &a, unsigned width, bool sign){
+		/*
+		 * Truncates a, or extends it with zeros (sign = false) or its MSB (sign = true).
+		 */
+		bvec r(a);
+		unsigned fill = (sign && !a.empty()) ? a.back() : BDD_FALSE;
+		r.resize(width, fill);
+		return r;
+	}
+
+	bvec bitNot(const bvec &a){
+		bvec r(a.size());
+		for(unsigned k = 0; k < a.size(); k++){
+			r[k] = m.Not(a[k]);
+		}
+		return r;
+	}
+
+	bvec bitwise(unsigned op, const bvec &a, const bvec &b){
+		bvec r(a.size());
+		for(unsigned k = 0; k < a.size(); k++){
+			r[k] = m.Apply(op, a[k], k < b.size() ? b[k] : BDD_FALSE);
+		}
+		return r;
+	}
+
+	bvec add(const bvec &a, const bvec &b, unsigned carry = BDD_FALSE){
+		/*
+		 * Ripple carry adder.
+		 */
+		bvec r(a.size());
+		unsigned bk, t;
+		for(unsigned k = 0; k < a.size(); k++){
+			bk = k < b.size() ? b[k] : BDD_FALSE;
+			t = m.Apply(XOR, a[k], bk);
+			r[k] = m.Apply(XOR, t, carry);
+			carry = m.Apply(OR, m.Apply(AND, a[k], bk), m.Apply(AND, t, carry));
+		}
+		return r;
+	}
+
+	bvec sub(const bvec &a, const bvec &b){
+		return add(a, bitNot(resize(b, a.size(), false)), BDD_TRUE);
+	}
+
+	bvec neg(const bvec &a){
+		return add(bitNot(a), constant(a.size(), 1));
+	}
+
+	bvec mul(const bvec &a, const bvec &b){
+		/*
+		 * Shift-and-add multiplier, truncated to the width of a.
+		 */
+		bvec r = constant(a.size(), 0), pp;
+		for(unsigned k = 0; k < b.size() && k < a.size(); k++){
+			pp = constant(a.size(), 0);
+			for(unsigned j = k; j < a.size(); j++){
+				pp[j] = m.Apply(AND, a[j-k], b[k]);
+			}
+			r = add(r, pp);
+		}
+		return r;
+	}
+
+	bvec mux(unsigned sel, const bvec &a, const bvec &b){
+		/*
+		 * sel ? a : b
+		 */
+		bvec r(a.size());
+		for(unsigned k = 0; k < a.size(); k++){
+			r[k] = m.Apply(OR, m.Apply(AND, sel, a[k]), m.Apply(AND, m.Not(sel), b[k]));
+		}
+		return r;
+	}
+
+	unsigned equal(const bvec &a, const bvec &b){
+		unsigned r = BDD_TRUE;
+		for(unsigned k = 0; k < a.size(); k++){
+			r = m.Apply(AND, r, m.Apply(EQUIV, a[k], k < b.size() ? b[k] : BDD_FALSE));
+		}
+		return r;
+	}
+
+	unsigned long long value(const bvec &a, const std::vector<int> &assignment){
+		/*
+		 * Evaluates a under an assignment (as returned by AnySat, don't cares read as 0).
+		 */
+		unsigned long long v = 0;
+		for(unsigned k = 0; k < a.size() && k < 64; k++){
+			unsigned u = a[k];
+			while(u > BDD_TRUE){
+				u = (assignment[m.varAt(m.level(u))] == 1) ? m.high(u) : m.low(u);
+			}
+			v |= (unsigned long long)u << k;
+		}
+		return v;
+	}
+};
+
+class transitionSystem{
+	/*
+	 * A sequential circuit represented by a partitioned transition relation. Every state
+	 * bit owns a current state variable and a next state variable, and the next state
+	 * variable is placed right below the current one in the variable order. Partition k
+	 * is the relation (next_k <-> f_k(current, inputs)).
+	 *
+	 * The image of a set of states is computed by conjoining the partitions one at a time
+	 * with AndExists(), quantifying every current state / input variable right after
+	 * the last partition that depends on it (early quantification).
+	 */
+	bddManager &m;
+	std::vector<unsigned> cur, nxt, inputs;
+	std::vector<unsigned> partitions;
+	std::vector<unsigned> cubes;	// variables quantified after each partition
+	unsigned firstCube;				// variables no partition depends on
+	unsigned toCurrent;				// renaming next -> current
+
+public:
+	unsigned init;
+	unsigned iterations;
+	unsigned long long peakNodes;		// most live nodes seen during image() / reach()
+
+	transitionSystem(bddManager &mgr) : m(mgr){
+		init = BDD_TRUE;
+		iterations = 0;
+		peakNodes = 0;
+		firstCube = BDD_TRUE;
+		toCurrent = 0;
+	}
+
+	void addState(unsigned curId, unsigned nextId){
+		cur.push_back(curId);
+		nxt.push_back(nextId);
+		partitions.push_back(BDD_TRUE);
+	}
+
+	void addInput(unsigned id){
+		inputs.push_back(id);
+	}
+
+	void setNext(unsigned k, unsigned f){
+		/*
+		 * Sets the next state function of state bit k.
+		 */
+		partitions[k] = m.Apply(EQUIV, m.ithVar(nxt[k]), f);
+	}
+
+	void schedule(){
+		/*
+		 * Computes the quantification schedule. Must be called once all next state
+		 * functions are set.
+		 */
+		std::vector<int> lastUse(m.read_numVars() + 1, -2);
+		std::vector< std::vector<unsigned> > quantify(partitions.size());
+		std::vector<unsigned> unused, sup;
+
+		for(unsigned k = 0; k < cur.size(); k++){
+			lastUse[cur[k]] = -1;
+		}
+		for(unsigned k = 0; k < inputs.size(); k++){
+			lastUse[inputs[k]] = -1;
+		}
+		for(unsigned p = 0; p < partitions.size(); p++){
+			sup = m.support(partitions[p]);
+			for(unsigned k = 0; k < sup.size(); k++){
+				if(lastUse[sup[k]] != -2){
+					lastUse[sup[k]] = p;
+				}
+			}
+		}
+		for(unsigned id = 1; id <= m.read_numVars(); id++){
+			if(lastUse[id] == -1){
+				unused.push_back(id);
+			}
+			else if(lastUse[id] >= 0){
+				quantify[lastUse[id]].push_back(id);
+			}
+		}
+		firstCube = m.cube(unused);
+		cubes.clear();
+		for(unsigned p = 0; p < partitions.size(); p++){
+			cubes.push_back(m.cube(quantify[p]));
+		}
+		toCurrent = m.addRenaming(nxt, cur);
+	}
+
+	unsigned image(unsigned S){
+		/*
+		 * Returns the set of states reachable in one step from S. S may also constrain
+		 * the inputs, which restricts the transitions that are taken.
+		 */
+		unsigned acc = m.Exists(S, firstCube);
+		for(unsigned p = 0; p < partitions.size(); p++){
+			acc = m.AndExists(acc, partitions[p], cubes[p]);
+			peakNodes = std::max(peakNodes, m.liveNodes());
+		}
+		return m.Replace(acc, toCurrent);
+	}
+
+	unsigned reach(){
+		/*
+		 * Forward reachability from init. The frontier handed to image() is simplified
+		 * against the states reached so far: any set between the new states and the
+		 * reached states has the same image modulo states already explored.
+		 * Returns BDD_ABORTED if an operation hit a limit of the manager.
+		 */
+		unsigned reached = init, frontier = init, img, fresh;
+		iterations = 0;
+		while(frontier != BDD_FALSE){
+			iterations++;
+			img = image(frontier);
+			fresh = m.Apply(AND, img, m.Not(reached));
+			frontier = m.Simplify(fresh, m.Not(reached));
+			reached = m.Apply(OR, reached, fresh);
+			peakNodes = std::max(peakNodes, m.liveNodes());
+			if(reached == BDD_ABORTED || frontier == BDD_ABORTED){
+				return BDD_ABORTED;
+			}
+		}
+		return reached;
+	}
+
+	double countStates(unsigned S){
+		/*
+		 * Number of states in S, where S only depends on current state variables.
+		 */
+		return m.SatCount(S) / pow(2, m.read_numVars() - cur.size());
+	}
+};
+
+class boothModel{
+	/*
+	 * BDD model of the booth module of Lab3/booth_8.sv, for any even width (FSM with
+	 * datapath, including the recodeLogic and add_subtract instances), with the asynchronous
+	 * reset treated as an input sampled on every clock edge. The initial state is the
+	 * reset state, which matches running ebmc with --reset reset==1.
+	 */
+	bddManager &m;
+	bitVector bv;
+	unsigned width, nextId;
+	std::vector<unsigned> stateCur;
+
+	enum fsmState {start, add, shift, finish};
+	// counter is reg [2:0] in booth_8.sv and booth_16.sv alike; it counts down from
+	// w/2-1 and wraps around to 7 on the last shift
+	static const unsigned COUNTER_BITS = 3;
+
+	bitVector::bvec newState(transitionSystem &ts, unsigned w, std::vector<unsigned> &curIds){
+		curIds.clear();
+		for(unsigned k = 0; k < w; k++){
+			curIds.push_back(nextId);
+			ts.addState(nextId, nextId + 1);
+			stateCur.push_back(nextId);
+			nextId += 2;
+		}
+		return bv.vars(curIds);
+	}
+
+	unsigned newInput(transitionSystem &ts){
+		ts.addInput(nextId);
+		return m.ithVar(nextId++);
+	}
+
+public:
+	unsigned cntWidth, cntReset;
+	bitVector::bvec curr_state, counter, mplr, mpld, product_reg, ma, mb;
+	unsigned stat_reg, init_reg;
+	unsigned reset, start_pulse;
+	bitVector::bvec multiplier, multiplicand;
+	unsigned next_is_finish;		// combinational next_state == finish
+
+	static unsigned variablesNeeded(unsigned w){
+		/*
+		 * Number of manager variables the model of width w allocates.
+		 */
+		return 2*(2 + COUNTER_BITS + 2 + 4*w + 2*w + 2) + 2 + 2*w;
+	}
+
+	boothModel(bddManager &mgr, unsigned w) : m(mgr), bv(mgr){
+		width = w;
+		nextId = 1;
+		cntWidth = COUNTER_BITS;
+		cntReset = w/2 - 1;
+	}
+
+	void build(transitionSystem &ts){
+		/*
+		 * Allocates the variables (control first, then the datapath interleaved bit by
+		 * bit) and sets the next state function of every register.
+		 */
+		typedef bitVector::bvec bvec;
+		std::vector<unsigned> ids, csIds, cntIds, srIds, irIds, prIds;
+		std::vector< std::vector<unsigned> > bitIds(6, std::vector<unsigned>(width));
+		unsigned pw = 2*width + 2;
+
+		reset = newInput(ts);
+		start_pulse = newInput(ts);
+		curr_state = newState(ts, 2, csIds);
+		counter = newState(ts, cntWidth, cntIds);
+		stat_reg = newState(ts, 1, srIds)[0];
+		init_reg = newState(ts, 1, irIds)[0];
+
+		// multiplier, mplr, ma, multiplicand, mpld, mb interleaved, then the product
+		for(unsigned k = 0; k < width; k++){
+			bitIds[0][k] = nextId; ts.addInput(nextId++);
+			for(unsigned v = 1; v < 3; v++){
+				bitIds[v][k] = nextId; ts.addState(nextId, nextId+1); nextId += 2;
+			}
+			bitIds[3][k] = nextId; ts.addInput(nextId++);
+			for(unsigned v = 4; v < 6; v++){
+				bitIds[v][k] = nextId; ts.addState(nextId, nextId+1); nextId += 2;
+			}
+		}
+		multiplier = bv.vars(bitIds[0]);
+		mplr = bv.vars(bitIds[1]);
+		ma = bv.vars(bitIds[2]);
+		multiplicand = bv.vars(bitIds[3]);
+		mpld = bv.vars(bitIds[4]);
+		mb = bv.vars(bitIds[5]);
+		product_reg = newState(ts, pw, prIds);
+
+		// recodeLogic and add_subtract
+		unsigned w0 = init_reg, w1 = mplr[0], w2 = mplr[1];
+		unsigned add_sub = w2;
+		unsigned skip = m.Apply(OR, m.Apply(AND, w2, m.Apply(AND, w1, w0)),
+								   m.Not(m.Apply(OR, w2, m.Apply(OR, w1, w0))));
+		unsigned dbl = m.Apply(OR, m.Apply(AND, m.Not(w2), m.Apply(AND, w1, w0)),
+								  m.Apply(AND, w2, m.Apply(AND, m.Not(w1), m.Not(w0))));
+		bvec sgn(1, mpld[width-1]);
+		bvec op_1 = bv.slice(product_reg, pw-1, width);
+		bvec op_2 = bv.mux(dbl, bv.concat(sgn, bv.concat(mpld, bv.constant(1,0))),
+								bv.concat(sgn, bv.concat(sgn, mpld)));
+		bvec op = bv.add(op_1, bv.mux(add_sub, bv.neg(op_2), op_2));
+
+		// FSMD datapath (always@*)
+		unsigned inStart = bv.equal(curr_state, bv.constant(2, start));
+		unsigned inAdd = bv.equal(curr_state, bv.constant(2, add));
+		unsigned inShift = bv.equal(curr_state, bv.constant(2, shift));
+		unsigned inFinish = bv.equal(curr_state, bv.constant(2, finish));
+		unsigned go = m.Apply(AND, inStart, start_pulse);
+		unsigned cntZero = bv.equal(counter, bv.constant(cntWidth, 0));
+
+		bvec next_state = bv.mux(go, bv.constant(2, add), curr_state);
+		next_state = bv.mux(inAdd, bv.constant(2, shift), next_state);
+		next_state = bv.mux(inShift, bv.mux(cntZero, bv.constant(2, finish), bv.constant(2, add)), next_state);
+		next_state = bv.mux(inFinish, bv.constant(2, start), next_state);
+		next_is_finish = m.Apply(AND, inShift, cntZero);
+
+		bvec nxt_cnt = bv.mux(inShift, bv.sub(counter, bv.constant(cntWidth, 1)), counter);
+		nxt_cnt = bv.mux(inFinish, bv.constant(cntWidth, cntReset), nxt_cnt);
+
+		bvec m1 = bv.mux(go, multiplier, mplr);
+		m1 = bv.mux(inShift, bv.concat(bvec(2, mplr[width-1]), bv.slice(mplr, width-1, 2)), m1);
+		m1 = bv.mux(inFinish, bv.constant(width, 0), m1);
+		bvec m2 = bv.mux(go, multiplicand, mpld);
+		m2 = bv.mux(inFinish, bv.constant(width, 0), m2);
+
+		bvec prod = bv.mux(go, bv.constant(pw, 0), product_reg);
+		prod = bv.mux(inAdd, bv.concat(bv.mux(skip, op_1, op), bv.slice(product_reg, width-1, 0)), prod);
+		prod = bv.mux(inShift, bv.concat(bvec(2, product_reg[pw-1]), bv.slice(product_reg, pw-1, 2)), prod);
+
+		unsigned status = m.Apply(OR, go, m.Apply(AND, m.Not(inFinish), stat_reg));
+		unsigned ireg = m.Apply(AND, m.Not(go), m.Apply(OR, m.Apply(AND, inShift, mplr[1]),
+																m.Apply(AND, m.Not(inShift), init_reg)));
+		unsigned load = m.Apply(AND, inStart, status);
+
+		// always@(posedge clk, posedge reset)
+		std::vector<unsigned> fn;
+		bvec zero;
+		zero = bv.mux(reset, bv.constant(2, start), next_state); fn.insert(fn.end(), zero.begin(), zero.end());
+		zero = bv.mux(reset, bv.constant(cntWidth, cntReset), nxt_cnt); fn.insert(fn.end(), zero.begin(), zero.end());
+		fn.push_back(m.Apply(AND, m.Not(reset), status));
+		fn.push_back(m.Apply(AND, m.Not(reset), ireg));
+		bvec nma = bv.mux(load, m1, ma), nmb = bv.mux(load, m2, mb);
+		for(unsigned k = 0; k < width; k++){
+			fn.push_back(m.Apply(AND, m.Not(reset), m1[k]));
+			fn.push_back(m.Apply(AND, m.Not(reset), nma[k]));
+			fn.push_back(m.Apply(AND, m.Not(reset), m2[k]));
+			fn.push_back(m.Apply(AND, m.Not(reset), nmb[k]));
+		}
+		for(unsigned k = 0; k < pw; k++){
+			fn.push_back(m.Apply(AND, m.Not(reset), prod[k]));
+		}
+		for(unsigned k = 0; k < fn.size(); k++){
+			ts.setNext(k, fn[k]);
+		}
+		ts.schedule();
+
+		// reset state
+		ts.init = bv.equal(curr_state, bv.constant(2, start));
+		ts.init = m.Apply(AND, ts.init, bv.equal(counter, bv.constant(cntWidth, cntReset)));
+		ts.init = m.Apply(AND, ts.init, m.Apply(AND, m.Not(stat_reg), m.Not(init_reg)));
+		ts.init = m.Apply(AND, ts.init, bv.equal(mplr, bv.constant(width, 0)));
+		ts.init = m.Apply(AND, ts.init, bv.equal(mpld, bv.constant(width, 0)));
+		ts.init = m.Apply(AND, ts.init, bv.equal(ma, bv.constant(width, 0)));
+		ts.init = m.Apply(AND, ts.init, bv.equal(mb, bv.constant(width, 0)));
+		ts.init = m.Apply(AND, ts.init, bv.equal(product_reg, bv.constant(pw, 0)));
+	}
+
+	unsigned s1_antecedent(){
+		// !reset && !stat_reg
+		return m.Apply(AND, m.Not(reset), m.Not(stat_reg));
+	}
+
+	unsigned s1_consequent(){
+		// counter == reset value
+		return bv.equal(counter, bv.constant(cntWidth, cntReset));
+	}
+
+	unsigned c4_antecedent(bool negative){
+		/*
+		 * !reset && next_state == finish && product_reg[top two bits] == 00 (c4a) or 11 (c4b),
+		 * the form of booth_8.sv, checked one cycle later (|=>). booth_16.sv states c4a/c4b
+		 * on curr_state == finish, checked in the same cycle (|->); that form is left to ebmc.
+		 */
+		unsigned pw = 2*width + 2;
+		unsigned top = bv.equal(bv.slice(product_reg, pw-1, pw-2), bv.constant(2, negative ? 3 : 0));
+		return m.Apply(AND, m.Not(reset), m.Apply(AND, next_is_finish, top));
+	}
+
+	unsigned c4_consequent(bool negative){
+		/*
+		 * c4a: product == probe_1 || product == probe_4
+		 * c4b: prod_inv == probe_2 || prod_inv == probe_3
+		 */
+		typedef bitVector::bvec bvec;
+		unsigned w2 = 2*width;
+		bvec product = bv.slice(product_reg, w2-1, 0);
+		bvec a = bv.resize(ma, w2, false), b = bv.resize(mb, w2, false);
+		bvec inv_a = bv.resize(bv.neg(ma), w2, false), inv_b = bv.resize(bv.neg(mb), w2, false);
+		if(!negative){
+			return m.Apply(OR, bv.equal(product, bv.mul(a, b)), bv.equal(product, bv.mul(inv_a, inv_b)));
+		}
+		bvec prod_inv = bv.neg(product);
+		return m.Apply(OR, bv.equal(prod_inv, bv.mul(b, inv_a)), bv.equal(prod_inv, bv.mul(a, inv_b)));
+	}
+};
+
+int checkNextState(bddManager &m, transitionSystem &ts, unsigned reached, unsigned antecedent,
+				   unsigned consequent, std::vector<int> &cex){
+	/*
+	 * Checks the property (antecedent |=> consequent) on the reached states: every
+	 * successor of a reached state satisfying the antecedent must satisfy the consequent.
+	 * Returns 1 if it holds, 0 if it fails (cex then holds an offending successor state)
+	 * and -1 if the check hit a limit of the manager.
+	 */
+	unsigned bad = m.Apply(AND, ts.image(m.Apply(AND, reached, antecedent)), m.Not(consequent));
+	if(bad == BDD_ABORTED){
+		return -1;
+	}
+	return m.AnySat(bad, cex) ? 0 : 1;
+}
+
+int checkAgainstSim(bddManager &m, boothModel &booth, transitionSystem &ts, unsigned reached,
+					unsigned width){
+	/*
+	 * Cross-checks the reached set with booth_sim (Lab3/booth_sim.cpp): every operand
+	 * pair is run from the reset state through one multiplication back to the start
+	 * state, every visited state must be in the reached set, and there must be as many
+	 * distinct visited states as reached ones. ma and mb, which booth_sim does not keep,
+	 * hold the operands latched by the start pulse (0 in the reset state). Only for
+	 * width <= 8, where all 2^(2*width) pairs are run and a state packs into 64 bits.
+	 * Returns 1 if both sets are equal, 0 otherwise.
+	 */
+	typedef bitVector::bvec bvec;
+	bitVector bv(m);
+	boothSim sim(width);
+	slice a[MAX_WIDTH], b[MAX_WIDTH];
+	std::vector<unsigned long long> visited;
+	std::vector<int> assignment(m.read_numVars() + 1, 0);
+	unsigned long long total = 1ULL << (2*width), mask = (1ULL << width) - 1, base, p;
+	unsigned long long ma, mb;
+	bool latched, fits;
+	double states;
+
+	// sets the variables of the state bits of v to value in assignment, false if
+	// value does not fit in v (the register is narrower in the model than in booth_sim)
+	auto assign = [&](const bvec &v, unsigned long long value){
+		for(unsigned k = 0; k < v.size(); k++){
+			assignment[m.varAt(m.level(v[k]))] = (value >> k) & 1;
+		}
+		return v.size() >= 64 || (value >> v.size()) == 0;
+	};
+	for(base = 0; base < total; base += LANES){
+		for(unsigned i = 0; i < width; i++){
+			for(int q = 0; q < LANE_WORDS; q++){
+				a[i].w[q] = b[i].w[q] = 0;
+				for(unsigned j = 0; j < 64; j++){
+					p = base + 64*q + j;
+					a[i].w[q] |= ((p >> i) & 1) << j;
+					b[i].w[q] |= ((p >> (width + i)) & 1) << j;
+				}
+			}
+		}
+		sim.cycle(true, false, NULL, NULL);
+		latched = false;
+		while(true){
+			for(unsigned j = 0; j < LANES && base + j < total; j++){
+				laneState s = sim.lane(j);
+				ma = latched ? (base + j) & mask : 0;
+				mb = latched ? ((base + j) >> width) & mask : 0;
+				fits = assign(booth.curr_state, s.curr_state) & assign(booth.counter, s.counter);
+				fits &= assign(bvec(1, booth.stat_reg), s.stat_reg) & assign(bvec(1, booth.init_reg), s.init_reg);
+				fits &= assign(booth.mplr, s.mplr) & assign(booth.mpld, s.mpld);
+				fits &= assign(booth.ma, ma) & assign(booth.mb, mb) & assign(booth.product_reg, s.product_reg);
+				if(!fits || bv.value(bvec(1, reached), assignment) != 1){
+					printf("\nbooth_sim: state of multiplier = %llu, multiplicand = %llu not in the reached set",
+							(base + j) & mask, ((base + j) >> width) & mask);
+					return 0;
+				}
+				visited.push_back(s.curr_state | (s.counter << 2) | ((unsigned long long)s.stat_reg << 5) |
+								  ((unsigned long long)s.init_reg << 6) | (s.mplr << 7) | (s.mpld << (7 + width)) |
+								  (ma << (7 + 2*width)) | (mb << (7 + 3*width)) | (s.product_reg << (7 + 4*width)));
+			}
+			if(latched && sim.lane(0).curr_state == 0){
+				break;
+			}
+			sim.cycle(false, !latched, a, b);
+			latched = true;
+		}
+	}
+	std::sort(visited.begin(), visited.end());
+	visited.erase(std::unique(visited.begin(), visited.end()), visited.end());
+	states = ts.countStates(reached);
+	printf("\nbooth_sim: %zu distinct states visited, %.0f reached", visited.size(), states);
+	return visited.size() == states;
+}
+
+int Reach_booth(unsigned width){
+	/*
+	 * Runs forward reachability on the booth FSM of the given width and checks the
+	 * safety properties s1, c4a and c4b, as booth_8.sv states them, against the reached
+	 * states, which are first compared with those of booth_sim (see checkAgainstSim()).
+	 * Widths above 8 do not finish: the reached set relates product_reg to ma*mb, whose
+	 * ROBDD grows exponentially with the width, so booth_16.sv is left to ebmc.
+	 * Returns the number of failing (or undecided) properties, plus one if the reached
+	 * states differ from booth_sim's, -1 if reachability was aborted.
+	 */
+	typedef std::chrono::steady_clock clk;
+	const char *names[] = {"s1", "c4a", "c4b"};
+	std::vector<int> cex;
+	unsigned reached, ante, cons;
+	int failed = 0, verdict;
+
+	if(width < 4 || width % 2 != 0 || width > 8){
+		printf("\nWidth must be even and between 4 and 8 (booth_16.sv is left to ebmc)"); fflush(stdout);
+		return -1;
+	}
+	clk::time_point t0 = clk::now();
+	bddManager m(boothModel::variablesNeeded(width));
+	m.setLimits(limitsFromEnv());
+	transitionSystem ts(m);
+	boothModel booth(m, width);
+	booth.build(ts);
+	clk::time_point t1 = clk::now();
+	reached = ts.reach();
+	clk::time_point t2 = clk::now();
+	if(reached == BDD_ABORTED){
+		printf("\nbooth (%d-bit): reachability aborted after %d iterations (%s), %llu live nodes\n",
+				width, ts.iterations, statusName(m.read_status()), m.liveNodes());
+		fflush(stdout);
+		return -1;
+	}
+
+	printf("\nbooth (%d-bit): %.0f reachable states, %d iterations, %d nodes in reached set",
+			width, ts.countStates(reached), ts.iterations, m.size(reached));
+	printf("\npeak live nodes: %llu, model build: %.3fs, reachability: %.3fs",
+			ts.peakNodes, std::chrono::duration<double>(t1 - t0).count(),
+			std::chrono::duration<double>(t2 - t1).count());
+
+	if(width <= 8 && !checkAgainstSim(m, booth, ts, reached, width)){
+		failed++;
+		printf("\nreached set differs from the states booth_sim visits");
+	}
+
+	printf("\nproperties as stated in booth_8.sv (c4a/c4b: next_state == finish |=> ...)");
+	for(int p = 0; p < 3; p++){
+		ante = (p == 0) ? booth.s1_antecedent() : booth.c4_antecedent(p == 2);
+		cons = (p == 0) ? booth.s1_consequent() : booth.c4_consequent(p == 2);
+		verdict = checkNextState(m, ts, reached, ante, cons, cex);
+		if(verdict == 1){
+			printf("\n%s: PASSED", names[p]);
+		}
+		else if(verdict == -1){
+			failed++;
+			printf("\n%s: UNDECIDED (%s)", names[p], statusName(m.read_status()));
+		}
+		else{
+			failed++;
+			bitVector bv(m);
+			printf("\n%s: FAILED, e.g. ma = %llu, mb = %llu, product_reg = %llu", names[p],
+					bv.value(booth.ma, cex), bv.value(booth.mb, cex), bv.value(booth.product_reg, cex));
+		}
+	}
+	printf("\nnodes allocated: %d, total time: %.3fs\n", m.read_index(),
+			std::chrono::duration<double>(clk::now() - t0).count());
+	fflush(stdout);
+	return failed;
+}
+
+int Add_probe(unsigned width){
+	/*
+	 * Represents the probe probe_1 = {0,ma} * {0,mb} of the booth module as an ADD,
+	 * and compares it with the ADD of the product bits built by the bit-level
+	 * multiplier of bitVector. Returns 0 if both agree.
+	 */
+	typedef std::chrono::steady_clock clk;
+	std::vector<unsigned> aIds, bIds;
+	bitVector::bvec a, b, bits;
+	unsigned word, fromBits, bitNodes = 0;
+
+	if(width < 1 || width > 16){
+		printf("\nWidth must be between 1 and 16"); fflush(stdout);
+		return -1;
+	}
+	clk::time_point t0 = clk::now();
+	addManager m(2*width);
+	bitVector bv(m);
+	for(unsigned k = 0; k < width; k++){
+		aIds.push_back(2*k + 1);
+		bIds.push_back(2*k + 2);
+	}
+	a = bv.vars(aIds);
+	b = bv.vars(bIds);
+	word = m.Times(m.fromBits(a, false), m.fromBits(b, false));
+	clk::time_point t1 = clk::now();
+	bits = bv.mul(bv.resize(a, 2*width, false), bv.resize(b, 2*width, false));
+	for(unsigned k = 0; k < bits.size(); k++){
+		bitNodes += m.size(bits[k]);
+	}
+	fromBits = m.fromBits(bits, false);
+	clk::time_point t2 = clk::now();
+
+	printf("\nprobe_1 (%d-bit operands): ADD %d nodes, %d terminals, built in %.3fs",
+			width, m.size(word), m.terminalCount(word), std::chrono::duration<double>(t1 - t0).count());
+	printf("\nbit-level product: %d BDDs, %d nodes in total, built in %.3fs",
+			2*width, bitNodes, std::chrono::duration<double>(t2 - t1).count());
+	printf("\nADD of the product bits %s the word-level ADD\n", (word == fromBits) ? "matches" : "DIFFERS from");
+	fflush(stdout);
+	return (word == fromBits) ? 0 : 1;
+}
+
+int Weights_check(unsigned n, unsigned rounds){
+	/*
+	 * Self-test of MinCostSat() and Probability() against enumeration: random functions
+	 * of n variables (random truth tables, built as a disjunction of their minterms)
+	 * with random integer costs and random probabilities, under a shuffled variable
+	 * order. The cost and the probability must equal those found by going through all
+	 * 2^n assignments, and the assignment returned by MinCostSat() must be a model of
+	 * that cost. Returns the number of failed checks.
+	 */
+	std::mt19937 mt(n);
+	std::uniform_real_distribution<double> unit(0.0, 1.0);
+	std::vector<unsigned> ids;
+	std::vector<double> cost0(n + 1), cost1(n + 1), prob(n + 1);
+	std::vector<int> assignment;
+	std::vector<bool> table;
+	unsigned f, cube, size;
+	int failed = 0;
+	double best, sum, c, q, got;
+
+	if(n < 1 || n > 12){
+		printf("\nNumber of variables must be between 1 and 12"); fflush(stdout);
+		return -1;
+	}
+	size = 1u << n;
+	bddManager m(n);
+	for(unsigned id = 1; id <= n; id++){
+		ids.push_back(id);
+	}
+	std::shuffle(ids.begin(), ids.end(), mt);
+	m.setOrder(ids.data(), n);
+	for(unsigned r = 0; r < rounds; r++){
+		f = BDD_FALSE;
+		table.assign(size, false);
+		for(unsigned id = 1; id <= n; id++){
+			cost0[id] = mt() % 10;
+			cost1[id] = mt() % 10;
+			prob[id] = unit(mt);
+		}
+		// sparse tables in every other round, so that the cheapest model is not trivial
+		for(unsigned a = 0; a < size; a++){
+			table[a] = (mt() % (r % 2 ? 16 : 2) == 0);
+			if(!table[a]){
+				continue;
+			}
+			cube = BDD_TRUE;
+			for(unsigned k = 0; k < n; k++){
+				cube = m.Apply(AND, cube, ((a >> k) & 1) ? m.ithVar(k + 1) : m.Not(m.ithVar(k + 1)));
+			}
+			f = m.Apply(OR, f, cube);
+		}
+		best = INFINITY;
+		sum = 0;
+		for(unsigned a = 0; a < size; a++){
+			c = 0;
+			q = 1;
+			for(unsigned k = 0; k < n; k++){
+				c += ((a >> k) & 1) ? cost1[k + 1] : cost0[k + 1];
+				q *= ((a >> k) & 1) ? prob[k + 1] : 1 - prob[k + 1];
+			}
+			if(table[a]){
+				best = std::min(best, c);
+				sum += q;
+			}
+		}
+		got = m.MinCostSat(f, cost0, cost1, assignment);
+		if(got != best){
+			failed++;
+			printf("\nround %d: MinCostSat %g, enumeration %g", r, got, best);
+		}
+		else if(best != INFINITY){
+			unsigned a = 0;
+			c = 0;
+			for(unsigned k = 0; k < n; k++){
+				a |= (assignment[k + 1] == 1) << k;
+				c += (assignment[k + 1] == 1) ? cost1[k + 1] : cost0[k + 1];
+			}
+			if(!table[a] || c != best){
+				failed++;
+				printf("\nround %d: MinCostSat assignment is not a model of cost %g", r, best);
+			}
+		}
+		got = m.Probability(f, prob);
+		if(fabs(got - sum) > 1e-9){
+			failed++;
+			printf("\nround %d: Probability %.12f, enumeration %.12f", r, got, sum);
+		}
+	}
+	printf("\nweights (%d variables): %d rounds, %d failed checks\n", n, rounds, failed);
+	fflush(stdout);
+	return failed;
+}
+
+unsigned zddOfFamily(zddManager &z, const std::vector<bool> &family, unsigned n){
+	/*
+	 * ZDD of a family of subsets of x1..xn given by its characteristic vector: set s
+	 * (bit k of s <=> x(k+1)) is in the family iff family[s].
+	 */
+	unsigned P = z.Empty(), S;
+	for(unsigned s = 0; s < family.size(); s++){
+		if(!family[s]){
+			continue;
+		}
+		S = z.Base();
+		for(unsigned k = 0; k < n; k++){
+			if((s >> k) & 1){
+				S = z.Change(S, k + 1);
+			}
+		}
+		P = z.Union(P, S);
+	}
+	return P;
+}
+
+std::vector<bool> familyOfZdd(zddManager &z, unsigned P, unsigned n){
+	/*
+	 * Inverse of zddOfFamily(): enumerates the sets of P with AnySet(), removing each
+	 * one from P until it is empty.
+	 */
+	std::vector<bool> family(1u << n, false);
+	std::vector<unsigned> set;
+	std::vector<bool> one;
+	unsigned s;
+	while(z.AnySet(P, set)){
+		s = 0;
+		for(unsigned k = 0; k < set.size(); k++){
+			s |= 1u << (set[k] - 1);
+		}
+		family[s] = true;
+		one.assign(1u << n, false);
+		one[s] = true;
+		P = z.Diff(P, zddOfFamily(z, one, n));
+	}
+	return family;
+}
+
+int Zdd_check(unsigned n, unsigned rounds){
+	/*
+	 * Self-test of zddManager against brute force: random families F and G of subsets
+	 * of x1..xn (each set drawn with probability 1/8, so that they are sparse) are
+	 * combined with every ZDD operation, and each result must be the very node of the
+	 * family computed on the characteristic vectors. Count() and the enumeration of F
+	 * are checked as well. The variable order is shuffled. Returns the number of
+	 * failed checks.
+	 */
+	const char *names[] = {"Union", "Intersect", "Diff", "Change", "OnSet", "OffSet"};
+	std::mt19937 mt(n);
+	std::vector<unsigned> ids;
+	std::vector<bool> F, G, R;
+	unsigned zF, zG, got = 0, x, bit, size;
+	int failed = 0;
+	double sets;
+
+	if(n < 1 || n > 12){
+		printf("\nNumber of variables must be between 1 and 12"); fflush(stdout);
+		return -1;
+	}
+	size = 1u << n;
+	zddManager z(n);
+	for(unsigned id = 1; id <= n; id++){
+		ids.push_back(id);
+	}
+	std::shuffle(ids.begin(), ids.end(), mt);
+	z.setOrder(ids.data(), n);
+	for(unsigned r = 0; r < rounds; r++){
+		F.assign(size, false);
+		G.assign(size, false);
+		sets = 0;
+		for(unsigned s = 0; s < size; s++){
+			F[s] = (mt() % 8 == 0);
+			G[s] = (mt() % 8 == 0);
+			sets += F[s];
+		}
+		x = mt() % n + 1;
+		bit = 1u << (x - 1);
+		zF = zddOfFamily(z, F, n);
+		zG = zddOfFamily(z, G, n);
+		if(z.Count(zF) != sets || familyOfZdd(z, zF, n) != F){
+			failed++;
+			printf("\nround %d: Count or enumeration of F wrong", r);
+		}
+		for(int op = 0; op < 6; op++){
+			R.assign(size, false);
+			for(unsigned s = 0; s < size; s++){
+				switch(op){
+					case 0: R[s] = F[s] || G[s]; break;
+					case 1: R[s] = F[s] && G[s]; break;
+					case 2: R[s] = F[s] && !G[s]; break;
+					case 3: R[s] = F[s ^ bit]; break;
+					case 4: R[s] = !(s & bit) && F[s | bit]; break;
+					case 5: R[s] = !(s & bit) && F[s]; break;
+				}
+			}
+			switch(op){
+				case 0: got = z.Union(zF, zG); break;
+				case 1: got = z.Intersect(zF, zG); break;
+				case 2: got = z.Diff(zF, zG); break;
+				case 3: got = z.Change(zF, x); break;
+				case 4: got = z.OnSet(zF, x); break;
+				case 5: got = z.OffSet(zF, x); break;
+			}
+			if(got != zddOfFamily(z, R, n)){
+				failed++;
+				printf("\nround %d: %s differs from brute force", r, names[op]);
+			}
+		}
+	}
+	printf("\nzdd (%d variables): %d rounds, %d failed checks, %llu live nodes\n", n, rounds, failed, z.liveNodes());
+	fflush(stdout);
+	return failed;
+}
+
+#include "verilog.cpp"						//Verilog front end (verilog command), uses bddManager and bitVector
+
+void Apply_ROBDD(ROBDD k, unsigned numVar_k){
+	/*
+	 * Wrapper function to Apply(). It accepts and parses another
+	 * boolean expression, creates it's ROBDDD and calls the Apply operation
+	 * on both the ROBDDs.
+	 */
+
+	char input[1000];	unsigned optr,c;
+	parser p2;		abSyntaxTree* exp_2;
+	ROBDD m;
+
+	printf("\nEnter next expression: ");
+	fflush(stdout);
+ 	while ( (c = getchar()) != '\n' && c != EOF );
+	fgets(input,MAX_LINE_SIZE,stdin);
+		if( input == NULL){
+			printf("\nIncorrect input");
+			fflush(stdout);
+		}
+	printf("%s",input);
+	fflush(stdout);
+	exp_2 = p2.formulaWrapper(input);
+	m.ROBDD_init(p2.numVar, p2.variables,p2.var_list, exp_2);
+	m.build();
+	ROBDD r;
+scan:
+/*
+ * Presents choice of Operations on ROBDD
+ */
+	printf("\n Enter Operand key: \n[1]AND\n[2]OR\n[3]IMPL\n[4]EQUIV");
+	fflush(stdout);
+	scanf("%d",&optr);
+	printf(" %d",optr);
+	if(optr>0 && optr<5){
+		m.Apply(&k,optr);
+	}
+
+	else{
+		printf("invalid choice\n\n");
+		fflush(stdout);
+		goto scan;
+	}
+	// prints out the adjacency list of the new ROBDD
+	for(unsigned i = 0; i< (m.read_index() +1); i++){
+		printf("\n%d %d %d %d", i, m.T[i].level, m.T[i].low, m.T[i].high);
+		fflush(stdout);
+	}
+
+}
+
+void Restrict_ROBDD(ROBDD k, unsigned NumVars){
+	/*
+	 * Wrapper to the Restrict function. It accepts the variable and it's
+	 * assignemnt with which to restrict the given ROBDD.
+	 */
+	ROBDD temp;
+	unsigned index,val;
+	fflush(stdout);
+	printf("\n Enter the variable which you wish to Restrict with: "); fflush(stdout);
+	scanf(" x%d",&index);
+	printf("\nIndex: %d\n Enter value to co-factor (0/1): ",index); fflush(stdout);
+	scanf(" %d",&val);
+	k.build();
+    k.Restrict(NumVars+2,(unsigned)index,val, &temp);
+
+	printf("\nRestricted Adjacency List:");
+	fflush(stdout);
+
+	//prints the Adjacency List of the  restricted ROBDD
+    for(unsigned i = 0; i<temp.read_index() + 1; i++){
+    			printf("\n%d %d %d %d", i, temp.T[i].level, temp.T[i].low, temp.T[i].high);
+    			fflush(stdout);
+    		}
+}
+
+void SatCount_ROBDD(ROBDD k, int numVar){
+	/*
+	 * Wrapper to SatCount function. Allows the user to choose between
+	 * computing for all nodes or for a specific node. It accepts the variable
+	 * number as input.
+	 */
+	int val, option,u, index;
+	printf("\nprint for all nodes? (Yes = 1 / No = 0)"); fflush(stdout);
+	scanf("%d",&option);
+	index= k.read_index();
+	if(!option){
+		printf("\n Enter Node number (u) : "); fflush(stdout);
+		scanf("%d",&u);
+		val = k.SatCount(u);
+		printf("\nNo. of values that satisfy node %d = %d ", u, val); fflush(stdout);
+
+	}
+	else{
+		for (int i = 0; i < index ; i++){
+			val = k.SatCount(i);
+			printf("\nNo. of values that satisfy node %d = %d ", i, val); fflush(stdout);
+		}
+	}
+}
+
+void AnySat_ROBDD(ROBDD k, int numVar){
+	/*
+	 * Wrapper to SatCount function. Allows the user to choose between
+	 * computing for all nodes or for a specific node. It accepts the variable
+	 * number as input.
+	 */
+	int val, option,u, index;
+	index = k.read_index();
+	printf("\nprint for all nodes?(Yes = 1 / No = 0)"); fflush(stdout);
+	scanf("%d",&option);
+	if(!option){
+		printf("\n Enter Node number (u) : "); fflush(stdout);
+		scanf("%d",&u);
+		val = k.SatCount(u);
+		printf("\nNo. of values that satisfy node %d = %d ", u, val); fflush(stdout);
+
+	}
+	else{
+			for (int i = 0; i < index ; i++){
+				k.AnySat(i);
+				printf("\nSatisfiability set for node%d : [", i); fflush(stdout);
+				for (unsigned j = 0; j < k.setSize ; j++){
+					printf(" %d", k.arr[j]);
+				}
+				printf(" ]"); fflush(stdout);
+
+			}
+	}
+}
+
+int Equiv_netlists(const char *arg_a, const char *arg_b){
+	/*
+	 * Parses both sides of an equivalence check and runs it. Returns 1 if the
+	 * sides are equivalent, 0 if they are not, -1 on a parse error and -2 if the
+	 * check hit one of the limits given by limitsFromEnv().
+	 */
+	parser pa, pb;
+	std::vector<abSyntaxTree*> a, b;
+	unsigned na, nb;
+
+	na = readNetlist(arg_a, pa, a);
+	nb = readNetlist(arg_b, pb, b);
+	if(na == 0 || nb == 0){
+		printf("\nINVALID EXPRESSION :("); fflush(stdout);
+		return -1;
+	}
+	if(a.size() != b.size()){
+		printf("\nNetlists have a different number of outputs (%zu vs %zu)", a.size(), b.size());
+		fflush(stdout);
+		return -1;
+	}
+	bddDiskCache *cache = openDiskCache();
+	equivResult res = equivalence(a, pa.variables, b, pb.variables, std::max(na,nb), cache, limitsFromEnv());
+	printEquivResult(res, std::max(na,nb));
+	if(cache != NULL){
+		printf("\nROBDD cache: %llu hits, %llu misses\n", cache->hits, cache->misses);
+		fflush(stdout);
+		delete cache;
+	}
+	if(res.status != BDD_OK){
+		return -2;
+	}
+	return res.equivalent ? 1 : 0;
+}
+
+int Portfolio_build(const char *arg, unsigned k){
+	/*
+	 * Builds a formula (or the first output of a netlist file) with a portfolio of
+	 * k variable orders and prints how each order fared. Returns 0 if one of the
+	 * builds finished.
+	 */
+	parser p;
+	std::vector<abSyntaxTree*> outputs;
+	portfolio pf;
+	unsigned numVars = readNetlist(arg, p, outputs);
+	int best;
+
+	if(numVars == 0 || outputs.empty()){
+		printf("\nINVALID EXPRESSION :("); fflush(stdout);
+		return -1;
+	}
+	if(k == 0){
+		k = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+	best = pf.run(outputs[0], p.variables, numVars, k);
+	const std::vector<portfolio::entry> &r = pf.results();
+	for(unsigned j = 0; j < r.size(); j++){
+		if(r[j].root == BDD_ABORTED){
+			printf("\n%-12s %s after %.3fs, %llu nodes", r[j].name.c_str(), statusName(r[j].status),
+					r[j].seconds, r[j].nodes);
+		}
+		else{
+			printf("\n%-12s ROBDD of %u nodes in %.3fs, %llu nodes made%s", r[j].name.c_str(), r[j].size,
+					r[j].seconds, r[j].nodes, ((int)j == best) ? "  <= smallest" : "");
+		}
+	}
+	printf("\n");
+	fflush(stdout);
+	return (best >= 0) ? 0 : 1;
+}
+
+int Sample_formula(const char *arg, unsigned k){
+	/*
+	 * Prints k uniformly drawn models of a formula (or of the first output of a
+	 * netlist file), one per line, as the values of x1..xn. Every block of samples
+	 * is checked against the formula with the bit-parallel simulator.
+	 */
+	parser p;
+	std::vector<abSyntaxTree*> outputs;
+	std::vector<unsigned long long> buffer;
+	std::mt19937_64 rng;		// default seed, so that runs are reproducible
+	simulator sim;
+	unsigned numVars = readNetlist(arg, p, outputs), blocks;
+
+	if(numVars == 0 || outputs.empty()){
+		printf("\nINVALID EXPRESSION :("); fflush(stdout);
+		return -1;
+	}
+	bddManager m(numVars);
+	m.setLimits(limitsFromEnv());
+	unsigned root = m.build(outputs[0], p.variables);
+	if(root == BDD_ABORTED){
+		printf("\nROBDD aborted (%s)\n", statusName(m.read_status())); fflush(stdout);
+		return -1;
+	}
+	blocks = m.SampleSat(root, k, rng, buffer);
+	if(blocks == 0){
+		printf("\nUnsatisfiable\n"); fflush(stdout);
+		return 1;
+	}
+	printf("\n%.0f models, %u samples:", m.SatCount(root), k);
+	for(unsigned j = 0; j < k; j++){
+		unsigned long long *block = &buffer[(size_t)(j / 64)*(numVars + 1)];
+		if(j % 64 == 0){
+			unsigned long long valid = (k - j >= 64) ? ~0ULL : ((1ULL << (k - j)) - 1);
+			if((~sim.simulate(outputs[0], p.variables, block) & valid) != 0){
+				printf("\nSAMPLE CHECK FAILED"); fflush(stdout);
+				return -1;
+			}
+		}
+		printf("\n");
+		for(unsigned id = 1; id <= numVars; id++){
+			printf("%d", (int)((block[id] >> (j % 64)) & 1));
+		}
+	}
+	printf("\n");
+	fflush(stdout);
+	return 0;
+}
+
+class incrementalBuilder{
+	/*
+	 * Rebuilds the ROBDD of a formula after edits, reusing the ROBDDs of the subtrees
+	 * that did not change. Subtrees are hash-consed: a subtree is identified by its
+	 * operator and the ids of its children (the variable number for a variable), so
+	 * structurally equal subtrees get the same id whether they come from the previous
+	 * parse or a new one. Each id keeps its ROBDD, hence after an edit only the
+	 * subtrees on the path from the edit to the root are new and only those run
+	 * Apply(). The rest of the tree is only hashed.
+	 *
+	 * Unlike bddManager::build() the tree is built one binary operator at a time, since
+	 * re-scheduling a whole n-ary chain would redo work the edit did not touch. The
+	 * subtrees unused by the last two builds are released: their ROBDDs are deref'ed
+	 * (and reclaimed by the next gc() of the manager), their key is erased and their
+	 * id is reused by later subtrees. Only the subtrees of the build two builds back
+	 * are candidates, so a build costs time in the size of the trees of the last
+	 * builds, not in everything built before.
+	 */
+	struct subtreeKey{
+		unsigned type, a, b;
+		bool operator==(const subtreeKey &o) const{
+			return type == o.type && a == o.a && b == o.b;
+		}
+	};
+
+	struct keyHash{
+		size_t operator()(const subtreeKey &k) const{
+			unsigned long long h = k.type;
+			h = h * 0x9E3779B97F4A7C15ULL + k.a;
+			h = h * 0x9E3779B97F4A7C15ULL + k.b;
+			return (size_t)(h ^ (h >> 29));
+		}
+	};
+
+	struct subtree_t{
+		subtreeKey key;
+		unsigned root;		// ROBDD, BDD_ABORTED if not built
+		unsigned lastUse;	// build in which it last appeared
+	};
+
+	bddManager &m;
+	std::unordered_map<subtreeKey, unsigned, keyHash> ids;	// key -> subtree id
+	std::vector<subtree_t> subtrees;						// by id
+	std::vector<unsigned> freeIds;							// ids of released subtrees
+	std::vector<unsigned> used, usedBefore, usedTwoBefore;	// ids seen by the last three builds
+	unsigned generation;
+
+	unsigned subtree(abSyntaxTree *node, bool *varBase){
+		/*
+		 * Returns the id of the subtree, building its ROBDD if it has none.
+		 */
+		subtreeKey key = {(unsigned)node->type, 0, 0};
+		unsigned id, u;
+		if(node->type == var){
+			key.a = (unsigned)(node->data - varBase) + 1;
+		}
+		else if(node->type != oprtr::T && node->type != oprtr::F){
+			key.a = subtree(node->lptr, varBase);
+			if(node->type != NOT){
+				key.b = subtree(node->rptr, varBase);
+			}
+		}
+		std::unordered_map<subtreeKey, unsigned, keyHash>::iterator it = ids.find(key);
+		if(it == ids.end()){
+			if(freeIds.empty()){
+				id = subtrees.size();
+				subtrees.push_back({key, BDD_ABORTED, 0});
+			}
+			else{
+				id = freeIds.back();
+				freeIds.pop_back();
+				subtrees[id] = {key, BDD_ABORTED, 0};
+			}
+			ids[key] = id;
+		}
+		else{
+			id = it->second;
+		}
+		if(subtrees[id].lastUse != generation){
+			subtrees[id].lastUse = generation;
+			used.push_back(id);
+		}
+		if(subtrees[id].root != BDD_ABORTED){
+			reused++;
+			return id;
+		}
+		switch(node->type){
+			case oprtr::T: u = BDD_TRUE; break;
+			case oprtr::F: u = BDD_FALSE; break;
+			case var: u = m.ithVar(key.a); break;
+			case NOT: u = m.Not(subtrees[key.a].root); break;
+			default:  u = m.Apply(node->type, subtrees[key.a].root, subtrees[key.b].root);
+		}
+		if(u != BDD_ABORTED){
+			m.ref(u);
+			subtrees[id].root = u;
+			built++;
+		}
+		return id;
+	}
+
+public:
+	unsigned reused;	// subtrees of the last build whose ROBDD was reused
+	unsigned built;		// subtrees of the last build that ran Apply()
+
+	incrementalBuilder(bddManager &mgr) : m(mgr){
+		generation = 0;
+		reused = built = 0;
+	}
+
+	~incrementalBuilder(){
+		for(unsigned id = 0; id < subtrees.size(); id++){
+			if(subtrees[id].root != BDD_ABORTED){
+				m.deref(subtrees[id].root);
+			}
+		}
+	}
+
+	unsigned size(){
+		// subtrees currently kept
+		return ids.size();
+	}
+
+	unsigned build(abSyntaxTree *node, bool *varBase){
+		/*
+		 * Same as bddManager::build(), varBase being the variables array of the
+		 * parser. Returns BDD_ABORTED if an operation hit a limit of the manager,
+		 * the subtrees built so far are kept for the next attempt.
+		 */
+		if(node == NULL){
+			printf("Incorrect abstract syntax Tree");
+			fflush(stdout);
+			return BDD_FALSE;
+		}
+		generation++;
+		reused = built = 0;
+		usedTwoBefore.swap(usedBefore);
+		usedBefore.swap(used);
+		used.clear();
+		unsigned u = subtrees[subtree(node, varBase)].root;
+		// a subtree unused since the build two builds back is released; its children
+		// were used at least as recently, so no key kept refers to a released id
+		for(unsigned k = 0; k < usedTwoBefore.size(); k++){
+			unsigned id = usedTwoBefore[k];
+			if(subtrees[id].lastUse + 2 == generation){
+				if(subtrees[id].root != BDD_ABORTED){
+					m.deref(subtrees[id].root);
+				}
+				ids.erase(subtrees[id].key);
+				subtrees[id].root = BDD_ABORTED;
+				freeIds.push_back(id);
+			}
+		}
+		return u;
+	}
+};
+
+class bddServer{
+	/*
+	 * Query server keeping one manager resident, so that functions built by earlier
+	 * requests (and the computed table) are reused by later ones. Requests are read one
+	 * per line and answered in order with one line each, so a client may send many
+	 * requests before reading the answers.
+	 *
+	 *   define <f> <formula>             f := formula (prefix syntax of the parser), built
+	 *                                    incrementally: subtrees seen recently are reused
+	 *   apply <f> <op> <g> [<h>]         f := g op h, op is AND, OR, IMPL, EQUIV, XOR or NOT (g only)
+	 *   restrict <f> <g> x<i>=<0|1> ...  f := g with the listed variables fixed
+	 *   satcount <f>                     models of f over x1..xn, n the largest variable seen
+	 *   equiv <f> <g>                    "equivalent" or "differ" with a distinguishing input
+	 *   mincost <f> x<i>=<c1>|<c0>:<c1>  cheapest model of f, setting x(i) to 0/1 costing c0/c1
+	 *                                    (c0 = 0 if omitted, unlisted variables cost nothing)
+	 *   prob <f> x<i>=<p> ...            probability of f, x(i) being true with probability p
+	 *                                    (0.5 for unlisted variables)
+	 *   free <f>                         forgets f, its nodes are reclaimed by the next gc
+	 *   reorder x<i> x<j> ...            moves the listed variables to the top of the order,
+	 *                                    in that order; the functions keep their names
+	 *   stats | quit
+	 *
+	 * An answer is "ok ..." or "error ..." followed by the time spent, e.g.
+	 * "ok f nodes=12 t=0.031ms". The limits of limitsFromEnv() apply to each request.
+	 */
+	typedef std::chrono::steady_clock clk;
+	bddManager m;
+	parser p;
+	incrementalBuilder builder;
+	std::map<std::string, unsigned> fns;
+	unsigned maxId;
+	unsigned long long lastLive;		// live nodes after the last gc
+	bool stop;
+
+	bool lookup(const std::string &name, unsigned &u, std::string &err){
+		std::map<std::string, unsigned>::iterator it = fns.find(name);
+		if(it == fns.end()){
+			err = "unknown function " + name;
+			return false;
+		}
+		u = it->second;
+		return true;
+	}
+
+	std::string aborted(){
+		// answer to a request whose operation hit a limit
+		return std::string("error aborted (") + statusName(m.read_status()) + ")";
+	}
+
+	bool bind(const std::string &name, unsigned u, std::string &answer){
+		if(u == BDD_ABORTED){
+			answer = aborted();
+			return false;
+		}
+		if(fns.count(name)){
+			m.deref(fns[name]);
+		}
+		m.ref(u);
+		fns[name] = u;
+		answer = "ok " + name + " nodes=" + std::to_string(m.size(u));
+		return true;
+	}
+
+	void collect(){
+		// gc once the nodes have doubled since the last one
+		if(m.liveNodes() > 2*lastLive){
+			m.gc();
+			lastLive = std::max(m.liveNodes(), 1024ULL);
+		}
+	}
+
+	std::string handle(char *line){
+		std::istringstream in(line);
+		std::string cmd, f, g, h, err;
+		unsigned u, v;
+
+		in >> cmd;
+		if(cmd == "define"){
+			if(!(in >> f)){
+				return "error usage: define <f> <formula>";
+			}
+			std::string rest;
+			std::getline(in, rest);
+			std::vector<char> text(rest.begin(), rest.end());
+			text.push_back(0);
+			abSyntaxTree *exp = p.formulaWrapper(text.data());
+			if(exp == NULL){
+				return "error cannot parse formula";
+			}
+			for(int k = 0; k < p.numVar; k++){
+				if(p.var_list[k] == 0 || p.var_list[k] > m.read_numVars()){
+					freeTree(exp);
+					return "error variable out of range";
+				}
+				maxId = std::max(maxId, p.var_list[k]);
+			}
+			// the builder keeps ids and ROBDDs, not the tree
+			if(bind(f, builder.build(exp, p.variables), err)){
+				err += " reused=" + std::to_string(builder.reused) + " built=" + std::to_string(builder.built);
+			}
+			freeTree(exp);
+			collect();
+			return err;
+		}
+		if(cmd == "apply"){
+			std::string op;
+			static const char *names[] = {"NOT", "AND", "OR", "IMPL", "EQUIV", "XOR"};
+			int k;
+			if(!(in >> f >> op >> g)){
+				return "error usage: apply <f> <op> <g> [<h>]";
+			}
+			for(k = 0; k < 6 && op != names[k]; k++);
+			if(k == 6){
+				return "error unknown operator " + op;
+			}
+			if(!lookup(g, u, err)){
+				return "error " + err;
+			}
+			if(k == NOT){
+				bind(f, m.Not(u), err);
+			}
+			else{
+				if(!(in >> h) || !lookup(h, v, err)){
+					return "error " + (err.empty() ? std::string("missing operand") : err);
+				}
+				bind(f, m.Apply(k, u, v), err);
+			}
+			collect();
+			return err;
+		}
+		if(cmd == "restrict"){
+			std::vector<unsigned> ids;
+			std::string lit;
+			unsigned literals = BDD_TRUE, id, b;
+			if(!(in >> f >> g) || !lookup(g, u, err)){
+				return "error " + (err.empty() ? std::string("usage: restrict <f> <g> x<i>=<0|1> ...") : err);
+			}
+			while(in >> lit){
+				if(sscanf(lit.c_str(), "x%u=%u", &id, &b) != 2 || id == 0 || id > m.read_numVars() || b > 1){
+					return "error bad literal " + lit;
+				}
+				unsigned x = m.ithVar(id);
+				literals = m.Apply(AND, literals, b ? x : m.Not(x));
+				ids.push_back(id);
+			}
+			// the cofactor is the relational product with the literals, quantified over their variables
+			bind(f, m.AndExists(u, literals, m.cube(ids)), err);
+			collect();
+			return err;
+		}
+		if(cmd == "satcount"){
+			if(!(in >> f) || !lookup(f, u, err)){
+				return "error " + (err.empty() ? std::string("usage: satcount <f>") : err);
+			}
+			char buf[64];
+			snprintf(buf, sizeof(buf), "%.0f", m.SatCount(u) / pow(2, m.read_numVars() - maxId));
+			return "ok " + std::string(buf);
+		}
+		if(cmd == "equiv"){
+			std::vector<int> cex;
+			if(!(in >> f >> g) || !lookup(f, u, err) || !lookup(g, v, err)){
+				return "error " + (err.empty() ? std::string("usage: equiv <f> <g>") : err);
+			}
+			if(u == v){
+				return "ok equivalent";
+			}
+			std::string answer = "ok differ";
+			unsigned x = m.Apply(XOR, u, v);
+			if(x == BDD_ABORTED){
+				return aborted();
+			}
+			m.AnySat(x, cex);
+			for(unsigned id = 1; id < cex.size(); id++){
+				if(cex[id] != -1){
+					answer += " x" + std::to_string(id) + "=" + std::to_string(cex[id]);
+				}
+			}
+			return answer;
+		}
+		if(cmd == "mincost" || cmd == "prob"){
+			std::vector<double> cost0(m.read_numVars() + 1, 0), cost1(m.read_numVars() + 1, 0);
+			std::vector<double> prob(m.read_numVars() + 1, 0.5);
+			std::vector<int> model;
+			std::string lit;
+			unsigned id;
+			double a, b;
+			char buf[64];
+			if(!(in >> f) || !lookup(f, u, err)){
+				return "error " + (err.empty() ? "usage: " + cmd + " <f> x<i>=<value> ..." : err);
+			}
+			while(in >> lit){
+				int fields = sscanf(lit.c_str(), "x%u=%lf:%lf", &id, &a, &b);
+				if(fields < 2 || id == 0 || id > m.read_numVars() || (cmd == "prob" && (fields != 2 || a < 0 || a > 1))){
+					return "error bad weight " + lit;
+				}
+				cost0[id] = (fields == 3) ? a : 0;
+				cost1[id] = (fields == 3) ? b : a;
+				prob[id] = a;
+			}
+			if(cmd == "prob"){
+				snprintf(buf, sizeof(buf), "%.12g", m.Probability(u, prob));
+				return "ok " + std::string(buf);
+			}
+			a = m.MinCostSat(u, cost0, cost1, model);
+			if(a == INFINITY){
+				return "ok unsatisfiable";
+			}
+			snprintf(buf, sizeof(buf), "%.12g", a);
+			std::string answer = "ok cost=" + std::string(buf);
+			for(id = 1; id <= maxId; id++){
+				answer += " x" + std::to_string(id) + "=" + std::to_string(model[id]);
+			}
+			return answer;
+		}
+		if(cmd == "free"){
+			if(!(in >> f) || !lookup(f, u, err)){
+				return "error " + (err.empty() ? std::string("usage: free <f>") : err);
+			}
+			m.deref(u);
+			fns.erase(f);
+			collect();
+			return "ok";
+		}
+		if(cmd == "reorder"){
+			std::vector<unsigned> ids;
+			std::string x;
+			unsigned id;
+			while(in >> x){
+				if(sscanf(x.c_str(), "x%u", &id) != 1 || id == 0 || id > m.read_numVars()){
+					return "error bad variable " + x;
+				}
+				ids.push_back(id);
+			}
+			if(ids.empty()){
+				return "error usage: reorder x<i> x<j> ...";
+			}
+			// only the nodes still in use are worth swapping
+			m.gc();
+			m.reorder(ids);
+			lastLive = std::max(m.liveNodes(), 1024ULL);
+			return "ok live=" + std::to_string(m.liveNodes());
+		}
+		if(cmd == "stats"){
+			return "ok functions=" + std::to_string(fns.size()) + " subtrees=" + std::to_string(builder.size()) +
+				   " live=" + std::to_string(m.liveNodes()) +
+				   " bytes=" + std::to_string(m.memoryBytes());
+		}
+		if(cmd == "quit"){
+			stop = true;
+			return "ok bye";
+		}
+		return "error unknown request " + cmd;
+	}
+
+public:
+	bddServer() : m(MAX_VARS), builder(m){
+		maxId = 0;
+		lastLive = 1024;
+		stop = false;
+		m.setOperationLimits(limitsFromEnv());
+	}
+
+	bool stopped(){
+		return stop;
+	}
+
+	void session(FILE *in, FILE *out){
+		/*
+		 * Serves requests from in until end of file or quit.
+		 */
+		char *line = NULL;
+		size_t cap = 0;
+		ssize_t len;
+		while(!stop && (len = getline(&line, &cap, in)) >= 0){
+			line[strcspn(line, "\r\n")] = 0;
+			if(line[0] == 0 || line[0] == '#'){
+				continue;
+			}
+			clk::time_point t0 = clk::now();
+			std::string answer = handle(line);
+			fprintf(out, "%s t=%.3fms\n", answer.c_str(),
+					std::chrono::duration<double, std::milli>(clk::now() - t0).count());
+			fflush(out);
+		}
+		free(line);
+	}
+};
+
+int Serve(const char *path){
+	/*
+	 * Runs the query server on stdin/stdout, or on the Unix domain socket path if
+	 * given, serving one connection at a time until a client sends quit. In stdio
+	 * mode the messages printed by the parser are moved to stderr so they do not
+	 * mix with the answers. accept() is retried after EINTR and ECONNABORTED only;
+	 * any other error stops the server with -1.
+	 */
+	bddServer *server = new bddServer();
+	if(path == NULL){
+		int fd = dup(1);
+		FILE *out = (fd < 0) ? NULL : fdopen(fd, "w");
+		if(out == NULL){
+			perror("serve");
+			if(fd >= 0){
+				close(fd);
+			}
+			delete server;
+			return -1;
+		}
+		dup2(2, 1);
+		server->session(stdin, out);
+		fclose(out);
+		delete server;
+		return 0;
+	}
+	struct sockaddr_un addr;
+	int s = socket(AF_UNIX, SOCK_STREAM, 0);
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+	unlink(path);
+	if(s < 0 || bind(s, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(s, 8) != 0){
+		perror("serve");
+		delete server;
+		return -1;
+	}
+	printf("\nlistening on %s\n", path); fflush(stdout);
+	int status = 0;
+	while(!server->stopped()){
+		int c = accept(s, NULL, NULL);
+		if(c < 0){
+			if(errno == EINTR || errno == ECONNABORTED){
+				continue;
+			}
+			// e.g. EMFILE: retrying at once would only spin
+			perror("accept");
+			status = -1;
+			break;
+		}
+		int d = dup(c);
+		FILE *in = fdopen(c, "r"), *out = (d < 0) ? NULL : fdopen(d, "w");
+		if(in == NULL || out == NULL){
+			perror("serve");
+			if(in != NULL) fclose(in); else close(c);
+			if(out != NULL) fclose(out); else if(d >= 0) close(d);
+			continue;
+		}
+		server->session(in, out);
+		fclose(in);
+		fclose(out);
+	}
+	close(s);
+	unlink(path);
+	delete server;
+	return status;
+}
+
+void Equiv_ROBDD(){
+	/*
+	 * Wrapper to the equivalence check. It accepts two boolean expressions (or
+	 * the names of two netlist files) and reports whether they are equivalent,
+	 * printing a distinguishing input if they are not.
+	 */
+	char input_a[MAX_LINE_SIZE], input_b[MAX_LINE_SIZE];
+	int c;
+
+	while ( (c = getchar()) != '\n' && c != EOF );
+	printf("\nEnter first expression (or netlist file): "); fflush(stdout);
+	if(fgets(input_a,MAX_LINE_SIZE,stdin) == NULL){
+		printf("\nIncorrect input"); fflush(stdout);
+		return;
+	}
+	printf("\nEnter second expression (or netlist file): "); fflush(stdout);
+	if(fgets(input_b,MAX_LINE_SIZE,stdin) == NULL){
+		printf("\nIncorrect input"); fflush(stdout);
+		return;
+	}
+	input_a[strcspn(input_a, "\r\n")] = 0;
+	input_b[strcspn(input_b, "\r\n")] = 0;
+	Equiv_netlists(input_a, input_b);
+}
+
+int main(int argc, char **argv){
+	/*
+	 * Where the Magic Happens!!
+	 *
+	 * The main function is designed to serve as a UI to the whole application.
+	 * It has a Menu system that allows the user to choose which operation must be performed
+	 * on the ROBDD.
+	 *
+	 * Passing "equiv <a> <b>" on the command line skips the menu and runs an
+	 * equivalence check, where <a> and <b> are formulas or netlist files.
+	 * "reach [width]" runs symbolic reachability on the booth FSM of Lab3 (width 4 to 8).
+	 * "addprobe [width]" compares the word-level ADD of probe_1 = ma*mb with the
+	 * product bits of the bit-level multiplier.
+	 * "zdd [n] [rounds]" checks the ZDD operations against brute force on n variables.
+	 * "weights [n] [rounds]" checks MinCostSat() and Probability() against enumeration.
+	 * "portfolio <a> [k]" builds a formula under k variable orders in parallel.
+	 * "sample <a> [k]" prints k uniformly drawn models of a formula.
+	 * "serve [socket]" runs the query server of bddServer on stdin/stdout or a socket.
+	 * "verilog <file> [top]" checks the immediate assertions of the modules of a Verilog
+	 * file (e.g. Lab3/booth_8.sv) with the BDD engine.
+	 */
+
+
+	abSyntaxTree *exp_1;
+	ROBDD k; parser p1;
+
+
+	char input[MAX_LINE_SIZE];
+	char *copy;
+	int option,c;
+
+	if(argc == 4 && strcmp(argv[1], "equiv") == 0){
+		return (Equiv_netlists(argv[2], argv[3]) == 1) ? 0 : 1;
+	}
+	if(argc >= 2 && strcmp(argv[1], "reach") == 0){
+		return (Reach_booth(argc > 2 ? atoi(argv[2]) : 8) == 0) ? 0 : 1;
+	}
+	if(argc >= 2 && strcmp(argv[1], "serve") == 0){
+		return (Serve(argc > 2 ? argv[2] : NULL) == 0) ? 0 : 1;
+	}
+	if(argc >= 3 && strcmp(argv[1], "sample") == 0){
+		return (Sample_formula(argv[2], argc > 3 ? atoi(argv[3]) : 10) == 0) ? 0 : 1;
+	}
+	if(argc >= 3 && strcmp(argv[1], "portfolio") == 0){
+		return Portfolio_build(argv[2], argc > 3 ? atoi(argv[3]) : 0);
+	}
+	if(argc >= 3 && strcmp(argv[1], "verilog") == 0){
+		return (Verilog_check(argv[2], argc > 3 ? argv[3] : NULL) == 0) ? 0 : 1;
+	}
+	if(argc >= 2 && strcmp(argv[1], "weights") == 0){
+		return (Weights_check(argc > 2 ? atoi(argv[2]) : 8, argc > 3 ? atoi(argv[3]) : 100) == 0) ? 0 : 1;
+	}
+	if(argc >= 2 && strcmp(argv[1], "zdd") == 0){
+		return (Zdd_check(argc > 2 ? atoi(argv[2]) : 8, argc > 3 ? atoi(argv[3]) : 100) == 0) ? 0 : 1;
+	}
+	if(argc >= 2 && strcmp(argv[1], "addprobe") == 0){
+		return (Add_probe(argc > 2 ? atoi(argv[2]) : 8) == 0) ? 0 : 1;
+	}
+
+new_exp:	// prompt user for boolean expression. Example expression given to explain grammar
+
+printf(" Enter formulae of proposition logic, one per line (max %d characters)", MAX_LINE_SIZE);fflush(stdout);
+	printf("\n Syntax is prefix. \nEg: ((!F OR F) IMPL ((F EQUIV T) AND T) in infix becomes");fflush(stdout);
+	printf("\n (IMPL (OR F (NOT F)) (AND (EQUIV F T) T)) in prefix \n");
+	fflush(stdout);
+	//fgets(input,MAX_LINE_SIZE,stdin);
+	if( input == NULL){
+		printf("\nIncorrect input");
+		goto new_exp;
+	}
+	//printf("\n%s",input);
+	//copy = input;
+	copy = BIG_TEST_STRING; 	
+	exp_1 = p1.formulaWrapper(copy);
+	k.ROBDD_init(p1.numVar,p1.variables,p1.var_list, exp_1);
+	k.build();
+
+	printf("\nPrinting Adjacency List of ROBDD.\nNote: Constant nodes 0/1 will be mapped to themselves\n"); fflush(stdout);
+	printf("\nu i l h"); fflush(stdout);
+// print adjacency list of Boolean expression received from user
+	for(unsigned i = 0; i<=k.read_index(); i++){
+			printf("\n%d %d %d %d", i, k.T[i].level, k.T[i].low, k.T[i].high);
+			fflush(stdout);
+		}
+menu:
+// Menu of Choices for operations on ROBDD
+	printf("\n\n\tMENU\n \n1.Apply\n2.Restrict\n3.Satisfiability Count\n4.AnySat check\n5.Enter new expression\n6.Equivalence check\n7.QUIT");
+	fflush(stdout);
+	printf("\nEnter Operation you wish to perform:");
+	fflush(stdout);
+	//scanf("%d",&option);
+	option = 7;
+
+	if(option < 0 && option > 7){
+		printf("INVALID option. Program Terminated.");
+		fflush(stdout);
+		exit(0);
+	}
+	switch(option){
+	case 1: Apply_ROBDD(k, p1.numVar);
+		goto menu; break;
+	case 2: Restrict_ROBDD(k,p1.numVar);
+		goto menu; break;
+	case 3: SatCount_ROBDD(k,p1.numVar);
+		goto menu; break;
+	case 4: AnySat_ROBDD(k,p1.numVar);
+		goto menu; break;
+	case 5:  while ( (c = getchar()) != '\n' && c != EOF );
+		goto new_exp;
+
+
+	case 6: Equiv_ROBDD();
+		goto menu; break;
+	case 7: printf("\n\nThank you for your time! Program Terminated."); fflush(stdout);break;
 
 	// for the keyboard slips...
 	default: printf("Invalid Choice!"); fflush(stdout); break;
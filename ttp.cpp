@@ -1,51 +1,296 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
 #include <math.h>
-#include <tuple>
+#include <bitset>
 #include <vector>
+#include <string>
 #include <algorithm>
 #include <random>       // random number generators
 #include <chrono>       // std::chrono::system_clock
 #include <limits>       // upper bound of int
+#include <fcntl.h>      // open, mmap: instance loader
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <iostream>
-//configuration parameters for each run
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+//configuration parameters for each run (can be overridden with -D)
+#ifndef MAXR
 #define MAXR 50
+#endif
+#ifndef MAXP
 #define MAXP 70
+#endif
+#ifndef MAXC
 #define MAXC 5000
+#endif
+#ifndef BETA
 #define BETA 0.9
+#endif
+#ifndef FACTOR
 #define FACTOR 1.1
+#endif
+#ifndef W0
 #define W0 60000
+#endif
+#ifndef T0
 #define T0 1000
+#endif
+//parallel tempering: number of replicas, temperature ladder, and moves per
+//replica between swaps
+#ifndef PT_REPLICAS
+#define PT_REPLICAS 8
+#endif
+#ifndef PT_TMAX
+#define PT_TMAX (5*T0)
+#endif
+#ifndef PT_TMIN
+#define PT_TMIN (T0/100)
+#endif
+#ifndef PT_SWEEP
+#define PT_SWEEP 5000
+#endif
+//backtracking: slots tried per attempt before restarting
+#ifndef BT_NODES
+#define BT_NODES 20000
+#endif
+//telemetry (compiled in with -DTTP_TELEMETRY): one move in TELEMETRY_SAMPLE
+//is timed, the rest are only counted
+#ifndef TELEMETRY_SAMPLE
+#define TELEMETRY_SAMPLE 64
+#endif
+
+// Element types of the schedule and distance matrices. A schedule entry is a
+// signed opponent number, so slot holds instances of up to 127 teams.
+typedef int8_t slot;
+typedef int32_t dst_t;
+// A set of signed opponents (games) of a team, opponent o as bit o + 128.
+typedef std::bitset<256> games;
+
+template <class T>
+T** newMatrix(int rows, int cols){
+  /*
+  Allocates a zeroed rows x cols matrix as a single cache-line aligned block,
+  with every row padded to whole cache lines, and returns the row pointers
+  into it, so that entries are still addressed as M[row][col].
+  */
+  size_t stride = ((cols*sizeof(T) + 63)/64)*64;
+  char *block = (char*) aligned_alloc(64, rows*stride);
+  T **M = (T**) malloc(rows*sizeof(T*));
+  memset(block, 0, rows*stride);
+  for (int i = 0; i < rows; i++) {
+    M[i] = (T*) (block + i*stride);
+  }
+  return M;
+}
 
-bool tuple_compare (std::tuple <int,int> t1, std::tuple <int,int> t2){
-  return (t1<=t2);
+template <class T>
+void freeMatrix(T **M){
+  //Frees a matrix allocated by newMatrix(): its block, then the row pointers
+  free(M[0]);
+  free(M);
 }
 
+class barrier{
+  /*
+  Reusable thread barrier: wait() returns once all "count" threads have
+  reached it. The tempering threads meet here only between sweeps, never
+  inside the annealing moves.
+  */
+  std::mutex m;
+  std::condition_variable cv;
+  int count, waiting = 0;
+  unsigned generation = 0;
+public:
+  barrier(int n) : count(n) {}
+  void wait(){
+    std::unique_lock<std::mutex> lock(m);
+    unsigned g = generation;
+    if(++waiting == count){
+      waiting = 0;
+      generation++;
+      cv.notify_all();
+    }
+    else{
+      cv.wait(lock, [&]{ return g != generation; });
+    }
+  }
+};
+
+std::vector<dst_t> readInstance(const char *path){
+  /*
+  Reads a TTP instance: the n x n distance matrix as whitespace separated
+  integers, as in the NL, CIRC and SUPER benchmark files (a leading n, as
+  some files have, is skipped). The file is memory-mapped and scanned in a
+  single pass, and n is inferred from the number of entries, so neither the
+  size nor the line layout has to be known. Returns an empty matrix if the
+  file cannot be read or does not hold a square matrix.
+  */
+  std::vector<dst_t> M;
+  struct stat st;
+  const char *p, *end, *c;
+  int fd = open(path, O_RDONLY), x;
+  size_t n;
+  bool neg;
+
+  if(fd < 0){
+    return M;
+  }
+  if(fstat(fd, &st) != 0 || st.st_size == 0){
+    close(fd);
+    return M;
+  }
+  p = (const char*) mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(p == MAP_FAILED){
+    return M;
+  }
+  end = p + st.st_size;
+  for(c = p; c < end; ){
+    if((*c >= '0' && *c <= '9') || (*c == '-' && c + 1 < end && c[1] >= '0' && c[1] <= '9')){
+      neg = (*c == '-');
+      c += neg;
+      for(x = 0; c < end && *c >= '0' && *c <= '9'; c++){
+        x = 10*x + (*c - '0');
+      }
+      M.push_back(neg ? -x : x);
+    }
+    else{
+      c++;
+    }
+  }
+  munmap((void*) p, st.st_size);
+
+  n = lround(sqrt(M.size()));
+  if(n*n != M.size()){
+    n = lround(sqrt(M.size() - 1));
+    if(M.size() > 1 && n*n == M.size() - 1 && M[0] == (dst_t) n){
+      M.erase(M.begin());
+    }
+    else{
+      M.clear();
+    }
+  }
+  return M;
+}
+
+std::vector<unsigned> deriveSeeds(unsigned master, int n){
+  /*
+  Seeds for n independent generators (one per thread, replica or run),
+  derived from a single master seed so that a whole multi-threaded search is
+  reproducible from it.
+  */
+  std::seed_seq seq{master};
+  std::vector<unsigned> seeds(n);
+  seq.generate(seeds.begin(), seeds.end());
+  return seeds;
+}
+
+void lower(std::atomic<unsigned> &best, unsigned cost){
+  // Lock-free best = min(best, cost), for costs shared between threads.
+  unsigned b = best.load();
+  while(cost < b && !best.compare_exchange_weak(b, cost));
+}
+
+struct cellWrite{
+  // a schedule entry overwritten by a move, as kept in the undo log
+  int team, rnd, old;
+};
+
+#ifdef TTP_TELEMETRY
+struct moveStats{
+  // moves of one type drawn by neighbourhood(), and how many of them were
+  // kept, improved on the current cost, or gave a schedule without violations
+  unsigned long long attempted, accepted, improving, feasible;
+};
+
+struct phaseRecord{
+  // state of the annealing at the end of a phase
+  unsigned reheat, phase;
+  double T, w;
+  unsigned bestFeasible, bestInfeasible;
+  unsigned long long iteration;
+};
+#endif
+
 class ttp{
 
-  int **dst_m;
-  int **schedule, **schedule1 , **schf;
+  dst_t **dst_m;
+  slot **schedule, **schedule1 , **schf;
   int teams, rounds;
   double w;
-  unsigned it = 0;
+  unsigned long long it = 0;
+  // (seconds, cost) of each new best valid schedule of the last TTSA run
+  std::vector < std::pair <double,unsigned> > history;
+  bool verbose = true;
   unsigned INF;
-  std::vector < std::tuple <int,int> > Q;
+  // backtracking state: games each team has (used) and games still possible
+  // in each round (open), with the number of slots tried and games placed
+  std::vector <games> used, open;
+  unsigned nodes, placed;
     // mt19937 is a standard mersenne_twister random number generator
   std::mt19937 mt;
+  // incremental cost: travel and violations of every team in schedule, with
+  // their totals, and the rounds of each team changed by the last move.
+  // Moves edit schedule in place and log what they overwrite in undo
+  int *teamDist, *teamViol, *newDist, *newViol;
+  int curDist, curViol;
+  int *changed, *numChanged;
+  unsigned *stamp, moveId = 1;
+  std::vector <int> touched;
+  std::vector <cellWrite> undo;
+  // search state of the annealing, per replica when tempering. oscillate is
+  // cleared by tempering(), whose replicas must all keep the weight W0
+  double costS, temp;
+  unsigned bestFeasible, bestInfeasible;
+  bool valid, oscillate = true;
+  // best cost over all threads of a multi-start search, if any
+  std::atomic<unsigned> *shared = 0;
+  // initial schedules by backtracking instead of the circle method
+  bool backtrack = false;
+#ifdef TTP_TELEMETRY
+  // telemetry of the last TTSA run: counters per move type (the last one
+  // drawn in lastMove), time in neighbourhood() and in pricing the moves over
+  // the sampled iterations, and a record per phase. Only plain stores on the
+  // annealing thread; writeTelemetry() formats them after the run
+  moveStats moves[5] = {};
+  int lastMove = 0;
+  double moveTime = 0, evalTime = 0;
+  unsigned long long attempts = 0, sampled = 0;
+  std::vector <phaseRecord> phases;
+#endif
 
   //private helper functions
-  void read_DM(FILE*,int);
-  int checkRR(int, int**);
-  int find(std::vector<std::tuple<int,int>> , std::tuple<int,int>);
+  int checkRR(int, slot**);
+  void placeGame(slot**, int, int, int);
+  void removeGame(slot**, int, int, int);
   void clearSchedule();
-  int compute_cost(int**);
-  int atmost(int**);
-  int noRepeat(int**);
-  double C(int**, int);
+  int compute_cost(slot**);
+  int atmost(slot**);
+  int noRepeat(slot**);
+  double C(slot**, int);
+  double C(int, int);
+  void set(int, int, int);
+  int travel(int, const slot*, int, int);
+  int violations(const slot*, int, int);
+  void initCost();
+  void delta(int&, int&);
+  void commit();
+  void rollback();
+  void initSearch();
+  int step(double);
 
 public:
 
-  ttp(FILE*, int);
+  ttp(const std::vector<dst_t>&);
+  ~ttp();
+  ttp(const ttp&) = delete;
+  ttp &operator=(const ttp&) = delete;
   int cost();
   //neighbourhood functions
   void swapHomes(int,int);
@@ -56,50 +301,70 @@ public:
   void neighbourhood();
   //initial solution generators
   void randomSchedule();
-  bool generateSchedule(std::vector < std::tuple <int,int> >, int**);
+  void circleSchedule();
+  void backtrackSchedule();
+  bool generateSchedule(slot**);
+  void useBacktracking(bool);
   //The Simulated Annealing algorithm
-  int ttsa_optimization();
+  int ttsa_optimization(unsigned target = 0, double limit = 0);
+  //Parallel tempering over replicas of one instance
+  static int tempering(std::vector<ttp*>&, int, unsigned, double);
+  //Independent TTSA runs shared out among threads
+  static int multiStart(std::vector<ttp*>&, const std::vector<unsigned>&, unsigned, double);
+  //statistics of the last TTSA run
+  unsigned long long iterations();
+  const std::vector < std::pair <double,unsigned> > &progress();
+  void setVerbose(bool);
+  bool writeTelemetry(const char*);
+  void copySchedule(const ttp&);
+  void saveSchedule(std::vector<slot>&);
+  void loadSchedule(const std::vector<slot>&);
+  void seed(unsigned);
   //public helper function
   void printSchedule();
 };
 
 
-ttp::ttp(FILE *fi, int numTeams){
-  //Contructor
-  teams = numTeams;
-  rounds = 2*numTeams - 2;
-  read_DM(fi, teams);
-
-  INF = std::numeric_limits<int>::max();
-  schedule = (int**) calloc(teams, sizeof(int*));
-  schedule1 = (int**) calloc(teams, sizeof(int*));
-  schf = (int**) calloc(teams, sizeof(int*));
+ttp::ttp(const std::vector<dst_t> &dist){
+  //Contructor, from the distance matrix given row by row (see readInstance())
+  teams = lround(sqrt(dist.size()));
+  rounds = 2*teams - 2;
+  dst_m = newMatrix<dst_t>(teams, teams);
   for (int i = 0 ; i < teams; i++)
     {
-      schedule[i] = (int*) calloc(rounds, sizeof(int));
-      schedule1[i] = (int*) calloc(rounds, sizeof(int));
-      schf[i] = (int*) calloc(rounds, sizeof(int));
+      memcpy(dst_m[i], &dist[i*teams], teams*sizeof(dst_t));
     }
+
+  INF = std::numeric_limits<int>::max();
+  schedule = newMatrix<slot>(teams, rounds);
+  schedule1 = newMatrix<slot>(teams, rounds);
+  schf = newMatrix<slot>(teams, rounds);
+  teamDist = (int*) calloc(teams, sizeof(int));
+  teamViol = (int*) calloc(teams, sizeof(int));
+  newDist = (int*) calloc(teams, sizeof(int));
+  newViol = (int*) calloc(teams, sizeof(int));
+  changed = (int*) calloc(teams*rounds, sizeof(int));
+  numChanged = (int*) calloc(teams, sizeof(int));
+  stamp = (unsigned*) calloc(teams*rounds, sizeof(unsigned));
     w = W0;
-    //Q.resize(teams*rounds);
 }
 
-void ttp::read_DM(FILE *fi, int size){
-  // Helper function that reads distance matrix from the specified txt file.
-  char c = '$';
-    dst_m = (int**)malloc(size*sizeof(int*));
-  for (int i = 0 ; i < size; i++)
-    {
-      dst_m[i] = (int*) malloc(size*sizeof(int));
-      for(int j = 0; j < size; j++)
-      {
-        fscanf(fi," %d", &dst_m[i][j]);
-      }
-      while((c=getc(fi)) != '\n');
-    }
+ttp::~ttp(){
+  //Destructor, frees the matrices and per-team arrays of the constructor
+  freeMatrix(dst_m);
+  freeMatrix(schedule);
+  freeMatrix(schedule1);
+  freeMatrix(schf);
+  free(teamDist);
+  free(teamViol);
+  free(newDist);
+  free(newViol);
+  free(changed);
+  free(numChanged);
+  free(stamp);
 }
 
-int ttp::checkRR(int team, int** S){
+int ttp::checkRR(int team, slot** S){
   /*
   Helper function that verifies whether the schedule for a specific team satisfies
   hard constraints. It utilizes the fact that a double round robin schedule
@@ -125,13 +390,11 @@ int ttp::checkRR(int team, int** S){
 void ttp::clearSchedule(){
   //Helper function to set all entries fo schedule to zeros.
   for (int team = 0; team < teams; team++) {
-    for (int rnd = 0; rnd < rounds; rnd++) {
-        schedule[team][rnd] = 0;
-    }
+    memset(schedule[team], 0, rounds*sizeof(slot));
   }
 }
 
-int ttp::compute_cost(int **S){
+int ttp::compute_cost(slot **S){
   /*
   Helper function that computes cost in terms of total distance travelled
   by all teams throughout the tournament.
@@ -160,7 +423,7 @@ int ttp::compute_cost(int **S){
   return cost;
 }
 
-int ttp::atmost(int** S){
+int ttp::atmost(slot** S){
   /*Tis function checks the soft constraint of having no more than three
     repeated home/away games. It returns the number of times this violation
     was made.
@@ -190,7 +453,7 @@ int ttp::atmost(int** S){
   return violations;
 }
 
-int ttp::noRepeat(int **S){
+int ttp::noRepeat(slot **S){
   /* This function checks the soft constraint of no repeated back-to-back games.
     It returns the no. of times two teams compete with each other
     for two back to back rounds .
@@ -210,14 +473,32 @@ int ttp::noRepeat(int **S){
   return violations;
 }
 
-int ttp::find(std::vector<std::tuple<int,int>> v, std::tuple<int,int> target){
-  /*Helper function to find a specific tuple in a vector of tuples*/
-  for(unsigned i = 0 ; i < v.size(); i++){
-    if(v[i] == target){
-      return i;
-    }
-  }
-  return -1;
+void ttp::placeGame(slot** S, int team, int rnd, int o){
+  /*
+  Backtracking helper: team (0-based) plays opponent o (signed, 1-based) in
+  round rnd, which also fixes the opponent's entry, and the constraint state
+  is updated to match.
+  */
+  int rival = abs(o) - 1, back = (o > 0) ? -(team + 1) : team + 1;
+  S[team][rnd] = o;
+  S[rival][rnd] = back;
+  used[team].set(o + 128);
+  used[rival].set(back + 128);
+  open[rnd].reset(team + 129).reset(127 - team);
+  open[rnd].reset(rival + 129).reset(127 - rival);
+  placed++;
+}
+
+void ttp::removeGame(slot** S, int team, int rnd, int o){
+  // Undoes placeGame(S, team, rnd, o).
+  int rival = abs(o) - 1, back = (o > 0) ? -(team + 1) : team + 1;
+  S[team][rnd] = 0;
+  S[rival][rnd] = 0;
+  used[team].reset(o + 128);
+  used[rival].reset(back + 128);
+  open[rnd].set(team + 129).set(127 - team);
+  open[rnd].set(rival + 129).set(127 - rival);
+  placed--;
 }
 
 void ttp::printSchedule(){
@@ -233,14 +514,21 @@ void ttp::printSchedule(){
   }
 }
 
-double ttp::C(int** S, int violations){
+double ttp::C(slot** S, int violations){
   /*
   Computes the cost of the schedule as a function of distance of travel
   and number of violations made by the current schedule. It penalizes violations
   using a sub-linear function.
   */
-    double cost = 0 , penalty = 0;
-    cost = compute_cost(S);
+  return C(compute_cost(S), violations);
+}
+
+double ttp::C(int distance, int violations){
+  /*
+  The same penalized cost for a schedule whose travel distance and number of
+  violations are already known (see initCost() and delta()).
+  */
+    double cost = distance , penalty = 0;
 
     if(violations == 0){
       return cost;
@@ -253,7 +541,157 @@ double ttp::C(int** S, int violations){
 }
 
 int ttp::cost(){
-  return (C(schedule1, atmost(schedule1) + noRepeat(schedule1)));
+  return (C(schedule, atmost(schedule) + noRepeat(schedule)));
+}
+
+void ttp::set(int team, int rnd, int value){
+  /*
+  Moves write schedule only through this function. The first write to an
+  entry logs its old value in undo, so that a rejected move can be rolled
+  back, and records the round changed in the team so that delta() can price
+  the move without rescanning the whole schedule.
+  */
+  if(stamp[team*rounds + rnd] != moveId){
+    stamp[team*rounds + rnd] = moveId;
+    undo.push_back({team, rnd, schedule[team][rnd]});
+    if(numChanged[team] == 0){
+      touched.push_back(team);
+    }
+    changed[team*rounds + numChanged[team]++] = rnd;
+  }
+  schedule[team][rnd] = value;
+}
+
+int ttp::travel(int t, const slot *row, int from, int to){
+  /*
+  Distance travelled by team t (0-based) on legs from..to of its schedule row.
+  Leg r ends at the venue of round r, and leg "rounds" is the trip home after
+  the last round, so travel(t, row, 0, rounds) is compute_cost() of one team.
+  */
+  int cost = 0, prev = t;
+  if(from > 0 && row[from-1] < 0){
+    prev = -row[from-1] - 1;
+  }
+  for(int r = from; r <= to && r < rounds; r++){
+    if(row[r] < 0){
+      cost += dst_m[prev][-row[r]-1];
+      prev = -row[r] - 1;
+    }
+    else{
+      cost += dst_m[t][prev];
+      prev = t;
+    }
+  }
+  if(to >= rounds && row[rounds-1] < 0){
+    cost += dst_m[t][-row[rounds-1]-1];
+  }
+  return cost;
+}
+
+int ttp::violations(const slot *row, int lo, int hi){
+  /*
+  Soft constraint violations of one team (as counted by atmost() and noRepeat())
+  around rounds lo..hi. The window is widened to the home/away streaks it
+  touches; a move that only changes rounds lo..hi leaves those streak ends in
+  place, so the difference of two such counts is the change in violations.
+  */
+  int from = (lo > 0) ? lo - 1 : 0, to = (hi < rounds - 1) ? hi + 1 : rounds - 1;
+  int streak = 0, v = 0;
+  while(from > 0 && (row[from-1] < 0) == (row[from] < 0)){
+    from--;
+  }
+  while(to < rounds - 1 && (row[to+1] < 0) == (row[to] < 0)){
+    to++;
+  }
+  for(int r = from; r <= to; r++){
+    streak = (r > from && (row[r] < 0) == (row[r-1] < 0)) ? streak + 1 : 1;
+    if(streak > 3){
+      v++;
+    }
+    if(r > from && abs(row[r]) == abs(row[r-1])){
+      v++;
+    }
+  }
+  return v;
+}
+
+void ttp::initCost(){
+  /*
+  Computes the per-team travel and violations of schedule from scratch, and
+  takes it as the last accepted schedule (schedule1).
+  */
+  curDist = curViol = 0;
+  for(int t = 0; t < teams; t++){
+    for(int r = 0; r < rounds; r++){
+      schedule1[t][r] = schedule[t][r];
+    }
+    teamDist[t] = travel(t, schedule[t], 0, rounds);
+    teamViol[t] = violations(schedule[t], 0, rounds - 1);
+    curDist += teamDist[t];
+    curViol += teamViol[t];
+  }
+}
+
+void ttp::delta(int &dDist, int &dViol){
+  /*
+  Change in travel and violations made by the last move, from schedule1 (the
+  last accepted schedule) to schedule, evaluated only for the teams it
+  touched, on the legs and streaks around the rounds it changed. Changed
+  rounds are grouped into windows; two groups are priced together when the
+  rounds between them form a single home/away streak, since a streak crossing
+  both would otherwise be counted twice. The new per-team values wait in
+  newDist/newViol until the move is accepted (commit()).
+  */
+  int t, lo, hi, n, *c, r;
+  bool streak;
+  dDist = dViol = 0;
+  for(unsigned k = 0; k < touched.size(); k++){
+    t = touched[k];
+    c = changed + t*rounds;
+    n = numChanged[t];
+    std::sort(c, c + n);
+    newDist[t] = teamDist[t];
+    newViol[t] = teamViol[t];
+    for(int i = 0; i < n; ){
+      lo = hi = c[i++];
+      while(i < n){
+        streak = true;
+        for(r = hi + 2; r < c[i] && streak; r++){
+          streak = ((schedule[t][r] < 0) == (schedule[t][r-1] < 0));
+        }
+        if(!streak){
+          break;
+        }
+        hi = c[i++];
+      }
+      newDist[t] += travel(t, schedule[t], lo, hi + 1) - travel(t, schedule1[t], lo, hi + 1);
+      newViol[t] += violations(schedule[t], lo, hi) - violations(schedule1[t], lo, hi);
+    }
+    dDist += newDist[t] - teamDist[t];
+    dViol += newViol[t] - teamViol[t];
+  }
+}
+
+void ttp::commit(){
+  // Accepts the last move: its entries and per-team values become current.
+  int t;
+  for(unsigned k = 0; k < touched.size(); k++){
+    t = touched[k];
+    curDist += newDist[t] - teamDist[t];
+    curViol += newViol[t] - teamViol[t];
+    teamDist[t] = newDist[t];
+    teamViol[t] = newViol[t];
+  }
+  for(unsigned k = 0; k < undo.size(); k++){
+    schedule1[undo[k].team][undo[k].rnd] = schedule[undo[k].team][undo[k].rnd];
+  }
+}
+
+void ttp::rollback(){
+  // Rejects the last move, restoring the entries it overwrote.
+  for(unsigned k = undo.size(); k-- > 0; ){
+    schedule[undo[k].team][undo[k].rnd] = undo[k].old;
+  }
 }
 
 void ttp::swapHomes(int team_i, int team_j){
@@ -261,44 +699,43 @@ void ttp::swapHomes(int team_i, int team_j){
   This function swaps the home and away games of two teams. If team_i
   plays at home with team_j in round k, then this function, would schedule
   team_i's game away at team_j's home in round k. A similar switch would be
-  done for other home/away games. This function operates on a copy of the main
-  schedule stored in schedule1.
+  done for other home/away games. Like all moves, it edits schedule in place
+  through set().
   */
   int round_k = 0, round_l = 0,temp = 0,temp1 = 0;
   for (int rnd = 0; rnd < rounds; ++rnd)
     {
-      if(schedule1[team_i - 1][rnd] == team_j)
+      if(schedule[team_i - 1][rnd] == team_j)
 	     {
 	        round_k = rnd;
 	       }
-      else if(schedule1[team_i - 1][rnd] == -1*team_j)
+      else if(schedule[team_i - 1][rnd] == -1*team_j)
 	     {
 	        round_l = rnd;
 	     }
     }
   //swap
-  temp = schedule1[team_i-1][round_k];
-  schedule1[team_i - 1][round_k] = schedule1[team_i-1][round_l];
-  schedule1[team_i-1][round_l] = temp;
-  temp1 = schedule1[team_j-1][round_k];
-  schedule1[team_j - 1][round_k] = schedule1[team_j-1][round_l];
-  schedule1[team_j-1][round_l] = temp1;
+  temp = schedule[team_i-1][round_k];
+  set(team_i - 1, round_k, schedule[team_i-1][round_l]);
+  set(team_i-1, round_l, temp);
+  temp1 = schedule[team_j-1][round_k];
+  set(team_j - 1, round_k, schedule[team_j-1][round_l]);
+  set(team_j-1, round_l, temp1);
 
 }
 
 void ttp::swapRounds(int round_k, int round_l){
   /*
   The swapRounds function swaps 2 rounds in the schedule. This is the same as
-  swapping two coloumns in our schedule matrix. This function operates on
-  schedule1 which is copy of the original schedule.
+  swapping two coloumns in our schedule matrix.
   */
   int temp = 0;
   for(int team = 0; team < teams; ++team)
     {
       //swap coloumn elements, row-by-row
-      temp = schedule1[team][round_k - 1];
-      schedule1[team][round_k - 1] = schedule1[team][round_l -1];
-      schedule1[team][round_l - 1] = temp;
+      temp = schedule[team][round_k - 1];
+      set(team, round_k - 1, schedule[team][round_l -1]);
+      set(team, round_l - 1, temp);
     }
 }
 
@@ -306,30 +743,29 @@ void ttp::swapTeams(int team_i, int team_j){
   /*
   This function swaps all games of two teams (except the one against each other).
   It also performs the necessary corrections in each round, that must be made
-  to ensure that the hard constarints of the schedule are satisfied. This
-  function alters a copy of the main schedule stored in schedule1.
+  to ensure that the hard constarints of the schedule are satisfied.
   */
   int temp = 0, t1 = 0;
   for (int rnd = 0; rnd < rounds; ++rnd) {
 
-    if(abs(schedule1[team_i-1][rnd]) != abs(team_j)){
+    if(abs(schedule[team_i-1][rnd]) != abs(team_j)){
       // swap games in current round
-      temp = schedule1[team_i-1][rnd];
-      t1 = schedule1[team_j-1][rnd];
-      schedule1[team_i-1][rnd] = t1;
-      schedule1[team_j-1][rnd] = temp;
+      temp = schedule[team_i-1][rnd];
+      t1 = schedule[team_j-1][rnd];
+      set(team_i-1, rnd, t1);
+      set(team_j-1, rnd, temp);
       // correct games of other teams in current round
       if(temp > 0){
-          schedule1[temp-1][rnd] = -1*team_j;
+          set(temp-1, rnd, -1*team_j);
       }
       else{
-        schedule1[abs(temp)-1][rnd] = team_j;
+        set(abs(temp)-1, rnd, team_j);
       }
       if(t1 > 0){
-        schedule1[t1 - 1][rnd] = -1*team_i;
+        set(t1 - 1, rnd, -1*team_i);
       }
       else{
-        schedule1[abs(t1) - 1][rnd] = team_i;
+        set(abs(t1) - 1, rnd, team_i);
       }
     }
   }
@@ -340,17 +776,16 @@ void ttp::partialSwapRounds(int team, int round_i, int round_j) {
   The partialSwapRounds function swaps the games in two rounds for the
   specified team. This swap sets of an ejection chain which swaps games of
   other teams in this round. This is done to satisfy an the hard constraint
-  of the schedule. This function alters a copy of the schedule stored in
-  schedule1.
+  of the schedule.
   */
   int temp = 0,valid = 0,rt = 0;
   bool swap = false,swapped[teams]={0};//index correction
   round_i --; round_j --; team --;
   int swaps = 0;
 
-  temp = schedule1[team][round_j];
-  schedule1[team][round_j] = schedule1[team][round_i];
-  schedule1[team][round_i] = temp;
+  temp = schedule[team][round_j];
+  set(team, round_j, schedule[team][round_i]);
+  set(team, round_i, temp);
   swap = false;
   swapped[team]= 1;
   // swap corresponding elements
@@ -360,29 +795,29 @@ void ttp::partialSwapRounds(int team, int round_i, int round_j) {
       valid = 1;
       if(temp < 0){
         temp*=-1;
-        if(schedule1[temp - 1][round_i] != team +1){
+        if(schedule[temp - 1][round_i] != team +1){
           swap = true;
           team = temp-1;
         }
       }
       else{
-        if(schedule1[temp - 1][round_i] != -1*(team + 1)){
+        if(schedule[temp - 1][round_i] != -1*(team + 1)){
           swap = true;
           team = temp-1;
           }
       }
       if(swap &&!swapped[team]){
         valid = 0;
-        temp = schedule1[team][round_j];
-        schedule1[team][round_j] = schedule1[team][round_i];
-        schedule1[team][round_i] = temp;
+        temp = schedule[team][round_j];
+        set(team, round_j, schedule[team][round_i]);
+        set(team, round_i, temp);
         swapped[team]= 1;
         swap = false;
 
         rt = round_j;
         round_j = round_i;
         round_i = rt;
-        temp = schedule1[team][round_i];
+        temp = schedule[team][round_i];
         swaps++;
       }
 
@@ -394,38 +829,37 @@ void ttp::partialSwapTeams(int team_i, int team_j ,int rnd){
   The partialSwapTeams function swaps the games of two teams in the specified
   round. This swap sets off an ejection chain that swaps games in the rest of
   the schedule to ensure that the schedule satisfies hard constraints.
-  This function alters a copy of the original schedule stored in schedule1.
   */
   int temp = 0, settled = 1, t1 = 0, rcount = 0;
   int rOrg = rnd - 1;
   int switched[rounds] = {0};
 
-  if(abs(schedule1[team_j-1][rnd-1]) == team_i){
+  if(abs(schedule[team_j-1][rnd-1]) == team_i){
     return;
   }
-  else if(abs(schedule1[team_i-1][rnd-1]) == team_j){
+  else if(abs(schedule[team_i-1][rnd-1]) == team_j){
     return;
   }
 
-  temp = schedule1[team_j-1][rnd-1];
-  t1 = schedule1[team_i-1][rnd-1];
-  schedule1[team_j-1][rnd-1] = t1;
-  schedule1[team_i-1][rnd-1] = temp;
+  temp = schedule[team_j-1][rnd-1];
+  t1 = schedule[team_i-1][rnd-1];
+  set(team_j-1, rnd-1, t1);
+  set(team_i-1, rnd-1, temp);
   switched[rnd-1] = 1;
   if(temp > 0){
-      schedule1[temp-1][rnd-1] = -1*team_i;
+      set(temp-1, rnd-1, -1*team_i);
   }
   else{
     temp*= -1;
-    schedule1[temp-1][rnd-1] = team_i;
+    set(temp-1, rnd-1, team_i);
     temp*= -1;
   }
   if(t1 > 0){
-    schedule1[t1 - 1][rnd-1] = -1*team_j;
+    set(t1 - 1, rnd-1, -1*team_j);
   }
   else{
     t1 *= - 1;
-    schedule1[abs(t1) - 1][rnd-1] = team_j;
+    set(abs(t1) - 1, rnd-1, team_j);
   }
 
   do{
@@ -439,30 +873,30 @@ void ttp::partialSwapTeams(int team_i, int team_j ,int rnd){
       rcount = (r + (rnd)) % rounds;
 
       //find conflicting entries in the teams schedule
-      if(schedule1[team_i-1][rcount] == temp){
+      if(schedule[team_i-1][rcount] == temp){
         if(rcount == rOrg){
           continue;
         }
         settled = 0;
         rOrg = rcount;
-        temp = schedule1[team_j-1][rcount];
-        t1 = schedule1[team_i-1][rcount];
-        schedule1[team_j-1][rcount] = t1;
-        schedule1[team_i-1][rcount] = temp;
+        temp = schedule[team_j-1][rcount];
+        t1 = schedule[team_i-1][rcount];
+        set(team_j-1, rcount, t1);
+        set(team_i-1, rcount, temp);
         if(temp > 0){
-            schedule1[temp-1][rcount] = -1*team_i;
+            set(temp-1, rcount, -1*team_i);
         }
         else{
           temp *= -1;
-          schedule1[temp-1][rcount] = team_i;
+          set(temp-1, rcount, team_i);
           temp *= -1;
         }
         if(t1 > 0){
-          schedule1[t1 - 1][rcount] = -1*team_j;
+          set(t1 - 1, rcount, -1*team_j);
         }
         else{
           t1 *= -1;
-          schedule1[t1 - 1][rcount] = team_j;
+          set(t1 - 1, rcount, team_j);
         }
         //printf("\n%d\tpost edit\n", (r+rnd)%rounds);
       }//endif
@@ -471,183 +905,163 @@ void ttp::partialSwapTeams(int team_i, int team_j ,int rnd){
 }
 
 void ttp::randomSchedule(){
-  /* This function initialzies the list containing tuples of (team,week). It
-  then invokes the recursive generateSchedule() function to construct the
-  initial schedule. The schedule generated needs to be verfied for hard
-  constraint (double-round robin) satisfaction. This is done by calling
-  the checkRR() function. generateSchdeule() can return incomplete schedules
-  because it was not able to assign teams with the randomized choice list
-  created, hence multiple instances of the function may have to be run.
+  /*
+  Generates a random initial schedule, by the circle method unless the
+  backtracking generator was asked for (useBacktracking()).
   */
-  //initialzie Q
-  int index = 0, valid = 0, cost_l = INF, c;
+  if(backtrack){
+    backtrackSchedule();
+  }
+  else{
+    circleSchedule();
+  }
+}
 
-  std::vector < std::tuple <int,int> > Qt;
+void ttp::useBacktracking(bool b){
+  backtrack = b;
+}
+
+void ttp::circleSchedule(){
+  /*
+  Builds a random double round robin in O(n^2) time with the circle (polygon)
+  method. Team n-1 sits in the centre and the others on a circle; in round r
+  the centre plays the team at place r, and the teams at places r+k and r-k
+  play each other. This canonical factorization gives the first half of the
+  tournament, and the second half repeats it with the venues swapped. The
+  teams are relabeled at random, the venues of each pair of games are flipped
+  at random, and the rounds are put in random order.
+  */
+  int half = teams - 1, a, b;
+  std::vector<int> label(teams), order(rounds);
+  std::uniform_int_distribution<int> coin(0,1);
 
-  Q.resize(teams*rounds);
-  // initialze the (team,week) list
   for (int team = 0; team < teams; ++team) {
-    for(int rnd = 0; rnd< rounds; ++rnd){
-      std::get<0>(Q[index]) = team+1;
-      std::get<1>(Q[index]) = rnd+1;
-      index++;
+    label[team] = team;
+  }
+  for(int rnd = 0; rnd < rounds; ++rnd){
+    order[rnd] = rnd;
+  }
+  std::shuffle(label.begin(), label.end(), mt);
+  std::shuffle(order.begin(), order.end(), mt);
+  for(int rnd = 0; rnd < half; ++rnd){
+    for(int k = 0; k < teams/2; ++k){
+      if(k == 0){
+        a = half;
+        b = rnd;
+      }
+      else{
+        a = (rnd + k) % half;
+        b = (rnd - k + half) % half;
+      }
+      if(coin(mt)){
+        std::swap(a, b);
+      }
+      a = label[a];
+      b = label[b];
+      // a hosts b in the first half, b hosts a in the second
+      schedule[a][order[rnd]] = b + 1;
+      schedule[b][order[rnd]] = -(a + 1);
+      schedule[a][order[rnd + half]] = -(b + 1);
+      schedule[b][order[rnd + half]] = a + 1;
     }
   }
+}
 
-  //sort the listlexicographically.
-  std::sort(Q.begin(), Q.end());
-  Qt.resize(Q.size());
-  // create a copy of the list to avoid regeneration.
-  Qt = Q;
+void ttp::backtrackSchedule(){
+  /*
+  Initial solution by randomized backtracking (generateSchedule()). An
+  attempt that runs out of its node budget is restarted from an empty
+  schedule; a completed one is a double round robin by construction. The
+  cheapest of 4 schedules generated this way is kept.
+  */
+  int cost_l = INF, c;
   for(int i = 0; i < 4 ; i++)
     {
       do{
-      Q = Qt;
-      generateSchedule(Q,schedule);
-        valid = 1;
-        for(int team = 1 ; team <= teams; ++team){
-          if(!checkRR(team, schedule)){
-            valid = 0;
-            // clear the invalid schedule
-            clearSchedule();
-            break;
+        // start from an empty schedule and constraint state
+        clearSchedule();
+        used.assign(teams, games());
+        open.assign(rounds, games());
+        for(int rnd = 0; rnd < rounds; ++rnd){
+          for (int team = 1; team <= teams; ++team) {
+            open[rnd].set(team + 128).set(128 - team);
           }
         }
-      }while(!valid);
-      //copy new schedule to schedule1.
+        nodes = placed = 0;
+      }while(!generateSchedule(schedule));
       c = cost();
       if(cost_l > c){
         cost_l = c;
         for (int team = 0; team < teams; ++team) {
-          for(int rnd = 0; rnd< rounds; ++rnd){
-            schedule1[team][rnd] = schedule[team][rnd];
-          }
+          memcpy(schedule1[team], schedule[team], rounds*sizeof(slot));
         }
-        clearSchedule();
       }
     }
 
     for (int team = 0; team < teams; ++team) {
-      for(int rnd = 0; rnd< rounds; ++rnd){
-        schedule[team][rnd] = schedule1[team][rnd];
-      }
+      memcpy(schedule[team], schedule1[team], rounds*sizeof(slot));
     }
 }
 
-bool ttp::generateSchedule(std::vector < std::tuple <int,int> > q , int** scheduleT){
+bool ttp::generateSchedule(slot** scheduleT){
   /*
   This function implments the recursion needed to arrive at an initial solution
-  via backtracking. It recursively calls itself when it finds that for the
-  selected team, the rival has not been assigned in the selected week. A copy
-  of the (team,week) list (q), is passed to the called function. The original
-  list is only updated if function returns true, indicating that assignment
-  attempted in the current iteration is acceptable. Otherwise, it tries another
-  configuration. The (team,week) pairs are stored as tuples, and all pairs are
-  stored as a vector of tuples.
-  */
-  if(q.size() == 0){
-    //Q.resize(0);
-    return true;
-  }
-
-  std::vector < std::tuple <int,int> > Qt;
-  std::tuple <int,int> local(0,0),chosen1(0,0);
-  int o = 0,w = 0,t = 0,id = 0, alloted = 0;
+  via backtracking. The games a slot (team, round) can still take are those
+  open in the round, that the team does not have yet, other than against
+  itself: a few word-wide bitset operations. The slot with the fewest such
+  games is filled next (most constrained first), so that a slot left with no
+  possible game ends a dead branch at once. Its games are tried in random
+  order; each is placed and undone in place, without copying any state.
+  Gives up after BT_NODES slots, so that the caller can restart.
+  */
+  int t = -1, w = -1, n, fewest = 2*teams;
+  games g;
   std::vector <int> Choices;
 
-  std::sort(q.begin(),q.end(),tuple_compare);
-  chosen1 = q[0];
-  t = std::get<0>(chosen1);
-  w = std::get<1>(chosen1);
-  std::get<1>(local) = w;
+  if(2*placed == (unsigned) (teams*rounds)){
+    return true;
+  }
+  if(++nodes > BT_NODES){
+    return false;
+  }
+  for (int team = 0; team < teams && fewest > 0; ++team) {
+    for(int rnd = 0; rnd < rounds && fewest > 0; ++rnd){
+      if(scheduleT[team][rnd] == 0){
+        g = open[rnd] & ~used[team];
+        n = g.count() - 2;  // both games against the team itself are open
+        if(n < fewest){
+          fewest = n;
+          t = team;
+          w = rnd;
+        }
+      }
+    }
+  }
+  if(fewest == 0){
+    return false;
+  }
 
-  for(int i = 1 ; i <= teams ; i++){
-    if(i==t){
+  g = open[w] & ~used[t];
+  for(int o = 1 ; o <= teams ; o++){
+    if(o == t + 1){
       continue;
     }
-      Choices.push_back(i);
-      Choices.push_back(-1*i);
+    if(g[o + 128]){
+      Choices.push_back(o);
+    }
+    if(g[128 - o]){
+      Choices.push_back(-1*o);
+    }
   }
-
-
-
-  //uses a custom RNG with a new seed for every run.
-    unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
-    std::shuffle (Choices.begin(),Choices.end(),std::default_random_engine(seed));
-
   //shuffling ensures that the order in which the rivals are assigned is random.
-
-    for (unsigned choice = 0; choice < Choices.size(); choice++) {
-      /* code */
-
-      o = Choices[choice];
-      std::get<0>(local) = abs(o);
-      if(find(q,local) != - 1){
-        alloted = 0;
-        for(int rnd = 0; rnd < rounds; rnd++){
-          if(scheduleT[t-1][rnd] == o){
-            alloted = 1;
-            break;
-          }
-        }
-        if(!alloted){
-          scheduleT[t-1][w-1] = o;
-        }
-        else{
-          continue;
-        }
-
-        if(o > 0){
-            for(int rnd = 0; rnd < rounds; rnd++){
-            if(scheduleT[o-1][rnd] == -1*t){
-              alloted = 1;
-              break;
-            }
-          }
-          if(!alloted){
-            scheduleT[o-1][w-1] = -1*t;
-          }
-          else{
-            continue;
-          }
-        }
-    else{
-        for(int rnd = 0; rnd < rounds; rnd++){
-        if(scheduleT[abs(o)-1][rnd] == t){
-          alloted = 1;
-          break;
-          }
-        }
-      //scheduleb[1] = scheduleT[o-1][w-1];
-        if(!alloted){
-          scheduleT[abs(o)-1][w-1] = t;
-        }
-        else{
-          continue;
-        }
-      }
-
-        std::get<0>(local) = abs(o);
-        //update set
-        Qt.resize(q.size());
-        Qt = q;
-        id = find(q,local);
-        if(id!= -1){
-          Qt.erase(Qt.begin() + id);
-        }
-        id = find(q,chosen1);
-        if(id!= -1){
-          Qt.erase(Qt.begin() + id);
-        }
-        Q.resize(Qt.size());
-        Q = Qt;
-        if(generateSchedule(Qt, scheduleT)){
-          q.resize(Q.size());
-          q = Q;
-          return true;
-        }
-      }//endif
-    }//endfor
+  std::shuffle (Choices.begin(),Choices.end(),mt);
+  for (unsigned choice = 0; choice < Choices.size(); choice++) {
+    placeGame(scheduleT, t, w, Choices[choice]);
+    if(generateSchedule(scheduleT)){
+      return true;
+    }
+    removeGame(scheduleT, t, w, Choices[choice]);
+  }
   return false;
 }
 
@@ -679,12 +1093,17 @@ void ttp::neighbourhood(){
   std::uniform_int_distribution<int> r(1,rounds);
 
   choice = dist(mt);
+#ifdef TTP_TELEMETRY
+  lastMove = (choice < PartialSwapRounds) ? choice : (choice < PartialSwapTeams) ? 3 : 4;
+#endif
 
-  for (int team = 0; team < teams; ++team) {
-    for(int rnd = 0; rnd< rounds; ++rnd){
-      schedule1[team][rnd] = schedule[team][rnd];
-    }
+  // forget the previous move; it has been committed or rolled back
+  for (unsigned k = 0; k < touched.size(); ++k) {
+    numChanged[touched[k]] = 0;
   }
+  touched.clear();
+  undo.clear();
+  moveId++;
   //generate team and round numbers.
   ti = (t(mt)); tj = (t(mt));
   ri = (r(mt)); rj = (r(mt));
@@ -717,98 +1136,177 @@ void ttp::neighbourhood(){
 
 }
 
-int ttp::ttsa_optimization(){
+void ttp::initSearch(){
+  // Starts a search from schedule: initial weight, no best schedule yet.
+  w = W0;
+  initCost();
+  costS = C(curDist, curViol);
+  bestFeasible = bestInfeasible = INF;
+  valid = false;
+}
+
+int ttp::step(double T){
+  /*
+  One TTSA iteration at temperature T: draws a move, prices it and either
+  keeps or rolls it back. A move is kept if it improves on the current cost
+  or on the best (in)feasible cost, or else if exp(-delta/T) > 0.5. New bests
+  adapt the violation weight w (strategic oscillation, unless oscillate is
+  cleared) and new best feasible schedules are stored in schf. Returns -1 if the move was rejected, 1 if it
+  was kept and improved a best cost, and 0 otherwise.
+  */
+  unsigned nbf = bestFeasible, nbi = bestInfeasible, nbv1;
+  int dDist = 0, dViol = 0;
+  double costS1, deltaCost = 0, imd = 0;
+  bool accept = false;
+#ifdef TTP_TELEMETRY
+  bool timed = (attempts++ % TELEMETRY_SAMPLE == 0);
+  std::chrono::steady_clock::time_point t0, t1, t2;
+  if(timed){
+    t0 = std::chrono::steady_clock::now();
+  }
+#endif
+
+  //neighbourhood edits the schedule in place, logging what it overwrites
+  neighbourhood();
+#ifdef TTP_TELEMETRY
+  if(timed){
+    t1 = std::chrono::steady_clock::now();
+  }
+#endif
+  delta(dDist, dViol);
+  nbv1 = curViol + dViol;
+  costS1 = C(curDist + dDist, nbv1);
+#ifdef TTP_TELEMETRY
+  if(timed){
+    t2 = std::chrono::steady_clock::now();
+    moveTime += std::chrono::duration<double>(t1 - t0).count();
+    evalTime += std::chrono::duration<double>(t2 - t1).count();
+    sampled++;
+  }
+  moves[lastMove].attempted++;
+  moves[lastMove].improving += (costS1 < costS);
+  moves[lastMove].feasible += (nbv1 == 0);
+#endif
+  if((costS1 < costS) ||
+  (nbv1 == 0 && costS1 < bestFeasible) ||
+  (nbv1 > 0 && costS1 < bestInfeasible))
+  {
+    accept = true;
+  }
+  else{
+    deltaCost = costS1 - costS;
+    imd = exp((double) (-1*deltaCost)/T);
+    if( imd > 0.5){
+        accept = true;
+    }
+    else{
+      accept = false;
+    }
+  }//endif
+  if(!accept){
+    rollback();
+    return -1;
+  }
+  //S <- S'
+  commit();
+#ifdef TTP_TELEMETRY
+  moves[lastMove].accepted++;
+#endif
+  costS = costS1;
+  if(nbv1 == 0){
+    nbf = (costS1 < bestFeasible) ? costS1 : bestFeasible;
+  }
+  else{
+    nbi = (costS1 < bestInfeasible) ? costS1 : bestInfeasible;
+  }//endif
+  if((nbf < bestFeasible) || (nbi < bestInfeasible)){
+    bestFeasible = nbf;
+    bestInfeasible = nbi;
+    if (nbv1 == 0){
+      valid = 1;
+      w = oscillate ? w/FACTOR : w;
+      //store the new valid schedule, the main copy gets updated later
+      for (int t = 0; t < teams; ++t) {
+        for (int r = 0; r < rounds; ++r) {
+          schf[t][r] = schedule[t][r];
+        }//endfor
+      }//endfor
+    }
+    else{
+      w = oscillate ? w*FACTOR : w;
+    }//endif nbv_
+    costS = C(curDist, curViol);
+    return 1;
+  }
+  return 0;
+}
+
+int ttp::ttsa_optimization(unsigned target, double limit){
   /*
   This implements the TTSA algorithm.
-  It computers number of violations,
-    at-> no. of "atmost 3 home/away games" constraint violation
-    nr-> no. of "no repeated games" constraint violation
-  cost of each modified schdeule and stores each new valid schedule
-  generated in schf. This ifed back to the schedule right before the
-  function returns
-  */
-  unsigned bestFeasible = INF , nbf = INF;
-  unsigned bestInfeasible = INF,nbi = INF;
+  It computers number of violations (atmost 3 home/away games, no repeated
+  games) and cost of each modified schdeule (see step()) and stores each new
+  valid schedule generated in schf. This ifed back to the schedule right
+  before the function returns. The search also stops once a valid schedule of
+  cost at most target is found, here or (in a multi-start search) by another
+  thread, or after limit seconds (when non-zero). The number of iterations
+  and the time and cost of every new best valid schedule are kept for
+  iterations() and progress(), and, when built with TTP_TELEMETRY, the
+  move statistics and phase trace for writeTelemetry().
+  */
   unsigned reheat = 0, counter = 0, phase = 0;
-  unsigned nbv = 0, nbv1 = 0, at = 0, nr = 0;;
-  double costS, costS1, deltaCost = 0;
-  bool accept = false, valid = false;
   double T = T0, bestTemp = T0;
-  double imd = 0;
-
-  while(reheat <= MAXR){
+  bool stop = false;
+  auto start = std::chrono::steady_clock::now();
+  std::chrono::duration<double> elapsed;
+
+  initSearch();
+  it = 0;
+  history.clear();
+#ifdef TTP_TELEMETRY
+  memset(moves, 0, sizeof(moves));
+  moveTime = evalTime = 0;
+  attempts = sampled = 0;
+  phases.clear();
+#endif
+  while(reheat <= MAXR && !stop){
     phase = 0;
-    printf("\nreheat:%d ", reheat);
+    if(verbose){
+      printf("\nreheat:%d ", reheat);
+    }
     //printSchedule();
-    while(phase <= MAXP){
+    while(phase <= MAXP && !stop){
       counter = 0;
       //printf("\nphase:%d ", phase);
-      while(counter <= MAXC){
-        //neighbourhood operates on a copy of the schedule by default;
-        neighbourhood();
-        at = atmost(schedule);
-        nr = noRepeat(schedule);
-        nbv = at + nr;
-        at = atmost(schedule1);
-        nr = noRepeat(schedule1);
-        nbv1 = at + nr;
-        costS1 = C(schedule1, nbv1);
-        costS = C(schedule, nbv);
-        if((costS1 < costS) ||
-        (nbv1 == 0 && costS1 < bestFeasible) ||
-        (nbv1 > 0 && costS1 < bestInfeasible))
+      while(counter <= MAXC && !stop){
+        switch(step(T))
         {
-          accept = true;
-        }
-        else{
-          deltaCost = costS1 - costS;
-          imd = exp((double) (-1*deltaCost)/T);
-          if( imd > 0.5){
-              accept = true;
-          }
-          else{
-            accept = false;
-          }
-        }//endif
-        if(accept){
-          //S <- S'
-          for (int t = 0; t < teams; ++t) {
-            for (int r = 0; r < rounds; ++r) {
-              schedule[t][r] = schedule1[t][r];
-            }//endfor
-          }//endfor
-          if(nbv1 == 0){
-            nbf = (costS1 < bestFeasible) ? costS1 : bestFeasible;
-          }
-          else{
-            nbi = (costS1 < bestInfeasible) ? costS1 : bestInfeasible;
-          }//endif
-          if((nbf < bestFeasible) || (nbi < bestInfeasible)){
-            // reset params if new best value found.
+          case 1: // reset params if new best value found.
             reheat = 0; counter = 0; phase = 0;
             bestTemp = T;
-            bestFeasible = nbf;
-            bestInfeasible = nbi;
-
-            if (nbv1 == 0){
-              valid = 1;
-              w = w/FACTOR;
-              //store the new valid schedule, the main copy gets updated later
-              for (int t = 0; t < teams; ++t) {
-                for (int r = 0; r < rounds; ++r) {
-                  schf[t][r] = schedule[t][r];
-                }//endfor
-              }//endfor
+            stop = (valid && bestFeasible <= target);
+            if(valid && (history.empty() || bestFeasible < history.back().second)){
+              elapsed = std::chrono::steady_clock::now() - start;
+              history.push_back(std::make_pair(elapsed.count(), bestFeasible));
             }
-            else{
-              w = w*FACTOR;
-            }//endif nbv_
-          }
-          else{
-            counter++;
-          }
-        }//endif
+            if(valid && shared != 0){
+              lower(*shared, bestFeasible);
+            }
+            break;
+          case 0: counter++;
+            break;
+          default:
+            break;
+        }
+        if((++it & 4095) == 0){
+          elapsed = std::chrono::steady_clock::now() - start;
+          stop = stop || (limit > 0 && elapsed.count() > limit);
+          stop = stop || (shared != 0 && *shared <= target);
+        }
       }//while !count
+#ifdef TTP_TELEMETRY
+      phases.push_back({reheat, phase, T, w, bestFeasible, bestInfeasible, it});
+#endif
       phase++;
       T = T*BETA;
     }//while !phase
@@ -818,12 +1316,16 @@ int ttp::ttsa_optimization(){
 
   //check whether a valid schedule was actually obtained
   if(!valid){
-    printf("\n NO VALID Schedule FOUND!\n");
-    printf("\n best bestInfeasible: %d \n", nbi);
-    fflush(stdout);
+    if(verbose){
+      printf("\n NO VALID Schedule FOUND!\n");
+      printf("\n best bestInfeasible: %d \n", bestInfeasible);
+      fflush(stdout);
+    }
     }
     else{
-      printf("\n Valid schdeule Found!");
+      if(verbose){
+        printf("\n Valid schdeule Found!");
+      }
     //copy best feasible schedule found so far into final schedule matrix.
     for (int t = 0; t < teams; ++t) {
       for (int r = 0; r < rounds; ++r) {
@@ -833,41 +1335,411 @@ int ttp::ttsa_optimization(){
   }
 
 
-  return nbf;
+  return bestFeasible;
+}
+
+void ttp::copySchedule(const ttp &src){
+  // Starts this instance from the schedule of another one of the same size.
+  for (int t = 0; t < teams; ++t) {
+    memcpy(schedule[t], src.schedule[t], rounds*sizeof(slot));
+  }
+}
+
+unsigned long long ttp::iterations(){
+  return it;
+}
+
+const std::vector < std::pair <double,unsigned> > &ttp::progress(){
+  return history;
+}
+
+void ttp::setVerbose(bool v){
+  verbose = v;
 }
 
+bool ttp::writeTelemetry(const char *prefix){
+  /*
+  Writes the telemetry of the last TTSA run as CSV files:
+    <prefix>.moves.csv   per move type: attempted, accepted, improving and
+                         feasible moves, and the acceptance rate
+    <prefix>.phases.csv  per phase: reheat and phase number, temperature,
+                         weight w, best (in)feasible cost and iteration count
+    <prefix>.time.csv    time in neighbourhood() and in pricing the moves,
+                         measured on one move in TELEMETRY_SAMPLE and scaled
+                         to all iterations
+  Returns false if the files cannot be written or the solver was built
+  without TTP_TELEMETRY.
+  */
+#ifdef TTP_TELEMETRY
+  static const char *names[5] = {"SwapTeams", "SwapHomes", "SwapRounds", "PartialSwapRounds", "PartialSwapTeams"};
+  std::string p = prefix;
+  FILE *mv = fopen((p + ".moves.csv").c_str(), "w");
+  FILE *ph = fopen((p + ".phases.csv").c_str(), "w");
+  FILE *tm = fopen((p + ".time.csv").c_str(), "w");
+  double scale = (sampled > 0) ? (double) attempts/sampled : 0;
+  bool ok = (mv != 0 && ph != 0 && tm != 0);
+
+  if(ok){
+    fprintf(mv, "move,attempted,accepted,improving,feasible,acceptance_rate\n");
+    for (int m = 0; m < 5; m++) {
+      fprintf(mv, "%s,%llu,%llu,%llu,%llu,%.4f\n", names[m], moves[m].attempted,
+      moves[m].accepted, moves[m].improving, moves[m].feasible,
+      (moves[m].attempted > 0) ? (double) moves[m].accepted/moves[m].attempted : 0);
+    }
+    fprintf(ph, "reheat,phase,temperature,w,best_feasible,best_infeasible,iteration\n");
+    for (const phaseRecord &r : phases) {
+      fprintf(ph, "%u,%u,%.4f,%.2f,", r.reheat, r.phase, r.T, r.w);
+      if(r.bestFeasible != INF){
+        fprintf(ph, "%u", r.bestFeasible);
+      }
+      fprintf(ph, ",");
+      if(r.bestInfeasible != INF){
+        fprintf(ph, "%u", r.bestInfeasible);
+      }
+      fprintf(ph, ",%llu\n", r.iteration);
+    }
+    fprintf(tm, "iterations,sampled,neighbourhood_s,evaluation_s\n");
+    fprintf(tm, "%llu,%llu,%.6f,%.6f\n", attempts, sampled, moveTime*scale, evalTime*scale);
+  }
+  if(mv) fclose(mv);
+  if(ph) fclose(ph);
+  if(tm) fclose(tm);
+  return ok;
+#else
+  (void) prefix;
+  return false;
+#endif
+}
 
-int main(){/*
-  Where The Magic Happens! The main function opens the file containing The
-  travel distances and passes the file pointer and the size of the problem
-  instance (number of teams), to the constructor object. It then invokes
-  randomSchedule to generate the initial greedy solution obtained by
-  backtracking. This solution is latter used by the ttsa_optimization
-  algorithm to generate a better schedule. Once the optimization is complete,
+void ttp::saveSchedule(std::vector<slot> &S){
+  // Stores schedule, team by team, in S.
+  S.resize(teams*rounds);
+  for (int t = 0; t < teams; ++t) {
+    memcpy(&S[t*rounds], schedule[t], rounds*sizeof(slot));
+  }
+}
+
+void ttp::loadSchedule(const std::vector<slot> &S){
+  // Restores a schedule stored by saveSchedule().
+  for (int t = 0; t < teams; ++t) {
+    memcpy(schedule[t], &S[t*rounds], rounds*sizeof(slot));
+  }
+}
+
+void ttp::seed(unsigned s){
+  mt.seed(s);
+}
+
+int ttp::multiStart(std::vector<ttp*> &rep, const std::vector<unsigned> &seeds, unsigned target, double limit){
+  /*
+  Multi-start TTSA: one run per seed, each a randomSchedule() followed by
+  ttsa_optimization() with the generator seeded from it, shared out among
+  one thread per instance in rep. Each thread keeps the best schedule of its
+  own runs; the best of those is left in rep[0] and its cost returned. The
+  best cost over all threads is only kept in an atomic, to report progress
+  and to stop every run once it reaches target. A run's result depends on
+  its seed alone, not on the number of threads, unless it is cut short.
+  */
+  int threads = rep.size(), runs = seeds.size(), best = 0;
+  std::atomic<int> next(0);
+  std::atomic<unsigned> shared(rep[0]->INF);
+  std::vector<unsigned> cost(threads, rep[0]->INF);
+  std::vector< std::vector<slot> > kept(threads);
+  std::vector<std::thread> pool;
+
+  for (int id = 0; id < threads; ++id) {
+    pool.push_back(std::thread([&, id]{
+      ttp *r = rep[id];
+      unsigned c;
+      r->shared = &shared;
+      for (int k = next++; k < runs && shared > target; k = next++) {
+        r->seed(seeds[k]);
+        r->randomSchedule();
+        c = r->ttsa_optimization(target, limit);
+        lower(shared, c);
+        printf("\nrun %d: cost %u, best so far %u", k, c, shared.load());
+        if(c < cost[id]){
+          cost[id] = c;
+          r->saveSchedule(kept[id]);
+        }
+      }
+      r->shared = 0;
+    }));
+  }
+  for (int id = 0; id < threads; ++id) {
+    pool[id].join();
+  }
+
+  for (int id = 1; id < threads; ++id) {
+    if(cost[id] < cost[best]){
+      best = id;
+    }
+  }
+  if(!kept[best].empty()){
+    rep[0]->loadSchedule(kept[best]);
+  }
+  return cost[best];
+}
+
+int ttp::tempering(std::vector<ttp*> &rep, int threads, unsigned target, double limit){
+  /*
+  Parallel tempering (replica exchange). Replica k anneals at a fixed
+  temperature of the geometric ladder from PT_TMAX down to PT_TMIN, running
+  step() with its own generator. The violation weight stays at W0 in every
+  replica (no strategic oscillation), so that all replicas share the energy
+  E = C(distance, violations). Every PT_SWEEP moves the threads meet at a
+  barrier and replicas of neighbouring temperatures swap temperatures with
+  probability min(1, exp((E_i - E_j)(1/T_i - 1/T_j))), so
+  good schedules drift down to the cold end while the hot end keeps
+  exploring. Swapping temperatures instead of schedules costs nothing, and
+  the moves themselves never synchronise: each thread owns a fixed slice of
+  the replicas. Stops once a valid schedule of cost at most target is found,
+  or after limit seconds (when non-zero); the best schedule found is left in
+  rep[0], whose cost is returned.
+  */
+  int R = rep.size(), best = 0;
+  std::vector<int> order(R);          // order[l]: replica at ladder level l
+  std::vector<std::thread> pool;
+  std::mt19937 mt(R);
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  barrier sync(threads);
+  bool done = false;
+  unsigned sweep = 0;
+  auto start = std::chrono::steady_clock::now();
+
+  for (int k = 0; k < R; ++k) {
+    order[k] = k;
+    rep[k]->temp = PT_TMAX*pow((double) PT_TMIN/PT_TMAX, (R > 1) ? (double) k/(R - 1) : 1.0);
+    rep[k]->oscillate = false;
+    rep[k]->initSearch();
+  }
+  for (int id = 0; id < threads; ++id) {
+    pool.push_back(std::thread([&, id]{
+      while(!done){
+        for (int k = id; k < R; k += threads) {
+          for (int i = 0; i < PT_SWEEP; ++i) {
+            rep[k]->step(rep[k]->temp);
+          }
+        }
+        sync.wait();
+        if(id == 0){
+          // exchange even or odd neighbour pairs, alternating every sweep
+          for (int l = sweep++ % 2; l + 1 < R; l += 2) {
+            ttp *a = rep[order[l]], *b = rep[order[l+1]];
+            double x = (a->costS - b->costS)*(1/a->temp - 1/b->temp);
+            if(x >= 0 || u(mt) < exp(x)){
+              std::swap(a->temp, b->temp);
+              std::swap(order[l], order[l+1]);
+            }
+          }
+          for (int k = 0; k < R; ++k) {
+            done = done || (rep[k]->valid && rep[k]->bestFeasible <= target);
+          }
+          std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+          done = done || (limit > 0 && elapsed.count() > limit);
+        }
+        sync.wait();
+      }
+    }));
+  }
+  for (int id = 0; id < threads; ++id) {
+    pool[id].join();
+  }
+
+  for (int k = 0; k < R; ++k) {
+    rep[k]->oscillate = true;
+  }
+  for (int k = 1; k < R; ++k) {
+    if(rep[k]->bestFeasible < rep[best]->bestFeasible){
+      best = k;
+    }
+  }
+  if(rep[best]->valid){
+    for (int t = 0; t < rep[0]->teams; ++t) {
+      memcpy(rep[0]->schedule[t], rep[best]->schf[t], rep[0]->rounds*sizeof(slot));
+    }
+  }
+  return rep[best]->bestFeasible;
+}
+
+#ifndef TTP_NO_MAIN
+// main() and its helpers; other programs include this file without them
+
+double timeToTarget(std::vector<ttp*> &rep, int threads, unsigned target, double limit, int &costf){
+  /*
+  Runs TTSA on rep[0] (threads == 0) or parallel tempering over all of rep
+  with the given number of threads, and returns the seconds it took.
+  */
+  auto start = std::chrono::steady_clock::now();
+  if(threads == 0){
+    costf = rep[0]->ttsa_optimization(target, limit);
+  }
+  else{
+    costf = ttp::tempering(rep, threads, target, limit);
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+int main(int argc, char **argv){/*
+  Where The Magic Happens! The main function reads the file containing The
+  travel distances (given as argument, data/data12.txt by default), which
+  also fixes the size of the problem instance (number of teams), and passes
+  them to the constructor object. It then invokes randomSchedule to generate
+  the initial solution (a random double round robin built by the circle
+  method, or by backtracking). This solution is latter used by the
+  ttsa_optimization algorithm to generate a better schedule. Once the optimization is complete,
   main() recives the cost of the optimized schedule, prints the optimized
   schedule to cli and prints total travel distance for the optimized schedule.
+
+  Usage: ttp [options] [instance file]
+    -seed S     master seed of every random number generator (default: clock)
+    -init I     initial schedules by the circle method (I = circle, default)
+                or by randomized backtracking (I = backtrack)
+    -target C   stop once a valid schedule of cost at most C is found
+    -time S     cut each TTSA or tempering run off after S seconds
+    -ms K       run TTSA from K random schedules and keep the best
+    -threads N  threads used by -ms (default: all cores)
+    -pt N       compare the time TTSA and parallel tempering on 1..N threads
+                take to reach -target, which is then required, from the same
+                initial schedule (each run is cut off after 600 s unless
+                -time is given)
+    -log P      write move statistics, the phase trace and timings of the
+                TTSA run to P.moves.csv, P.phases.csv and P.time.csv (needs
+                a build with -DTTP_TELEMETRY)
   */
-  int costf = 0;
-  FILE *fi;
+  int costf = 0, cost1 = 0, threads = 0, runs = 0, teams, R;
+  unsigned target = 0;
+  unsigned master = std::chrono::system_clock::now().time_since_epoch().count();
+  double limit = 0, t1, tk;
+  bool pt = false, backtrack = false;
+  const char *path = "data/data12.txt", *logPrefix = 0;
+  std::vector<dst_t> dist;
+  std::vector<ttp*> rep;
+  std::vector<unsigned> seeds;
+
+  for (int i = 1; i < argc; i += 2) {
+    if(argv[i][0] != '-'){
+      path = argv[i--];
+      continue;
+    }
+    if(i + 1 >= argc){
+      printf("\n Missing value of option %s", argv[i]);
+      exit(-1);
+    }
+    if(strcmp(argv[i], "-seed") == 0){
+      master = strtoul(argv[i+1], 0, 10);
+    }
+    else if(strcmp(argv[i], "-init") == 0){
+      backtrack = (strcmp(argv[i+1], "backtrack") == 0);
+    }
+    else if(strcmp(argv[i], "-target") == 0){
+      target = strtoul(argv[i+1], 0, 10);
+    }
+    else if(strcmp(argv[i], "-time") == 0){
+      limit = atof(argv[i+1]);
+    }
+    else if(strcmp(argv[i], "-ms") == 0){
+      runs = atoi(argv[i+1]);
+    }
+    else if(strcmp(argv[i], "-threads") == 0){
+      threads = atoi(argv[i+1]);
+    }
+    else if(strcmp(argv[i], "-pt") == 0){
+      pt = true;
+      threads = atoi(argv[i+1]);
+    }
+    else if(strcmp(argv[i], "-log") == 0){
+      logPrefix = argv[i+1];
+    }
+    else{
+      printf("\n Unknown option %s", argv[i]);
+      exit(-1);
+    }
+  }
+  if(pt && target == 0){
+    printf("\n -pt needs -target C, the cost the runs are timed to");
+    exit(-1);
+  }
+  printf("\nseed: %u", master);
 
-  //Change name of file for different instances
-  fi = fopen("data/data12.txt","r");
-  if(fi == 0)
+  dist = readInstance(path);
+  if(dist.empty())
     {
-      printf("\n Unable to open file. Program terminated");
+      printf("\n Unable to read a distance matrix from %s. Program terminated", path);
       exit(-1);
     }
+  teams = lround(sqrt(dist.size()));
+  if(teams < 4 || teams % 2 || teams > 127)
+    {
+      printf("\n %s has %d teams, an even number from 4 to 127 is needed", path, teams);
+      exit(-1);
+    }
+  printf("\n%s: %d teams", path, teams);
+
+   if(runs > 0){
+     threads = (threads > 0) ? threads : std::thread::hardware_concurrency();
+     threads = (threads > 0) ? threads : 1;
+     for (int k = 0; k < threads; ++k) {
+       rep.push_back(new ttp(dist));
+       rep[k]->useBacktracking(backtrack);
+     }
+     costf = ttp::multiStart(rep, deriveSeeds(master, runs), target, limit);
+     rep[0]->printSchedule();
+     printf("\n Distance: %d", costf);
+     for (int k = 0; k < threads; ++k) {
+       delete rep[k];
+     }
+     return 0;
+   }
 
-   ttp inst(fi,12);
+   ttp inst(dist);
+   inst.useBacktracking(backtrack);
+   if(!pt){
+     inst.seed(master);
+     inst.randomSchedule();
+     printf("\nInitialized...");
+     costf = inst.ttsa_optimization(target, limit);
+     inst.printSchedule();
+     printf("\n Distance: %d", costf);
+     if(logPrefix != 0 && !inst.writeTelemetry(logPrefix)){
+       printf("\n No telemetry written to %s.*.csv (built without TTP_TELEMETRY?)", logPrefix);
+     }
+     return 0;
+   }
+
+   // one replica per ladder level, all starting from the same schedule
+   limit = (limit > 0) ? limit : 600;
+   R = (threads > PT_REPLICAS) ? threads : PT_REPLICAS;
+   seeds = deriveSeeds(master, R + 1);
+   for (int k = 0; k < R; ++k) {
+     rep.push_back(new ttp(dist));
+   }
+   inst.seed(seeds[R]);
    inst.randomSchedule();
    printf("\nInitialized...");
-   costf = inst.ttsa_optimization();
-   inst.printSchedule();
-
-   fclose(fi);
-   printf("\n Distance: %d", costf);
+   rep[0]->copySchedule(inst);
+   rep[0]->seed(seeds[0]);
+   t1 = timeToTarget(rep, 0, target, limit, cost1);
+   printf("\n\nTTSA: cost %d in %.2f s", cost1, t1);
+   for (int n = 1; n <= threads; ++n) {
+     for (int k = 0; k < R; ++k) {
+       rep[k]->copySchedule(inst);
+       rep[k]->seed(seeds[k]);
+     }
+     tk = timeToTarget(rep, n, target, limit, costf);
+     printf("\nPT, %d thread(s): cost %d in %.2f s", n, costf, tk);
+     if((unsigned) costf <= target && (unsigned) cost1 <= target){
+       printf(", speedup %.2f", t1/tk);
+     }
+   }
+   printf("\n");
+   for (int k = 0; k < R; ++k) {
+     delete rep[k];
+   }
 
   return 0;
 }
+#endif
 
 // *************************** END OF CODE ************************************
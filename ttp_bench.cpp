@@ -0,0 +1,240 @@
+/*
+Benchmark of the TTSA solver of ttp.cpp on the standard NL and CIRC instances.
+
+Every instance is solved once per seed (seeds derived from a fixed master seed,
+so runs are repeatable) with a time limit per run, stopping early if the best
+known cost is reached. The results are written as CSV, so that two versions of
+ttp.cpp can be compared on throughput and on solution quality:
+
+  <out>.runs.csv     one row per run: seconds, iterations and iterations per
+                     second, whether a valid schedule was found, its cost, the
+                     gap to the best known cost and the time at which the run
+                     first came within each -within percentage of it
+  <out>.trace.csv    best valid cost over time of every run
+  <out>.summary.csv  per instance: whether it was run or its file is missing,
+                     feasibility rate, best and mean cost, mean iterations per
+                     second, and for each -within percentage the fraction of
+                     runs that got there and their mean time
+
+CIRC instances (team i at position i of a circle, distance the number of steps
+between positions) are generated here. The NL instances are not bundled; they
+are read from <data>/nl<n>.txt (or NL<n>.txt) and skipped if missing, which
+leaves a "missing" row in the summary.
+
+Build: g++ -O2 -pthread -o ttp_bench ttp_bench.cpp
+Usage: ttp_bench [-seeds K] [-time S] [-within 1,5,10] [-data dir] [-out prefix]
+*/
+#define TTP_NO_MAIN
+#include "ttp.cpp"
+#include <string>
+#include <ctype.h>
+
+struct instance{
+  const char *name;
+  int teams;
+  unsigned best;      // best known cost (optimal up to CIRC10), 0 if none
+  bool circ;          // generated here, else read from the data directory
+};
+
+static const instance suite[] = {
+  {"NL4", 4, 8276, false},
+  {"NL6", 6, 23916, false},
+  {"NL8", 8, 39721, false},
+  {"NL10", 10, 59436, false},
+  {"NL12", 12, 110729, false},
+  {"NL14", 14, 188728, false},
+  {"NL16", 16, 261687, false},
+  {"CIRC4", 4, 20, true},
+  {"CIRC6", 6, 64, true},
+  {"CIRC8", 8, 132, true},
+  {"CIRC10", 10, 242, true},
+  {"CIRC12", 12, 408, true},
+  {"CIRC14", 14, 654, true},
+  {"CIRC16", 16, 928, true},
+  {"CIRC18", 18, 1306, true},
+  {"CIRC20", 20, 1842, true},
+};
+
+std::vector<dst_t> circMatrix(int n){
+  // Distance matrix of CIRCn: min(|i-j|, n-|i-j|).
+  std::vector<dst_t> M(n*n);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      M[i*n + j] = std::min(abs(i - j), n - abs(i - j));
+    }
+  }
+  return M;
+}
+
+std::vector<dst_t> loadNL(const std::string &dir, const instance &in){
+  // Reads an NL instance from the data directory, trying both name cases.
+  std::string lower = in.name;
+  std::vector<dst_t> M;
+  std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+  M = readInstance((dir + "/" + lower + ".txt").c_str());
+  if(M.empty()){
+    M = readInstance((dir + "/" + in.name + ".txt").c_str());
+  }
+  if(!M.empty() && M.size() != (size_t) (in.teams*in.teams)){
+    M.clear();
+  }
+  return M;
+}
+
+std::vector<double> parseList(const char *s){
+  // "1,5,10" -> {1, 5, 10}
+  std::vector<double> v;
+  char *end;
+  while(*s){
+    v.push_back(strtod(s, &end));
+    if(end == s){
+      break;
+    }
+    s = (*end == ',') ? end + 1 : end;
+  }
+  return v;
+}
+
+int main(int argc, char **argv){
+  int seedCount = 5;
+  double limit = 10;
+  std::vector<double> within = {1, 5, 10};
+  std::string dir = "data", out = "bench";
+  std::vector<unsigned> seeds;
+  FILE *runs, *trace, *summary;
+  int skipped = 0;
+
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if(strcmp(argv[i], "-seeds") == 0){
+      seedCount = atoi(argv[i+1]);
+    }
+    else if(strcmp(argv[i], "-time") == 0){
+      limit = atof(argv[i+1]);
+    }
+    else if(strcmp(argv[i], "-within") == 0){
+      within = parseList(argv[i+1]);
+    }
+    else if(strcmp(argv[i], "-data") == 0){
+      dir = argv[i+1];
+    }
+    else if(strcmp(argv[i], "-out") == 0){
+      out = argv[i+1];
+    }
+    else{
+      printf("Unknown option %s\n", argv[i]);
+      exit(-1);
+    }
+  }
+  seeds = deriveSeeds(1, seedCount);
+
+  runs = fopen((out + ".runs.csv").c_str(), "w");
+  trace = fopen((out + ".trace.csv").c_str(), "w");
+  summary = fopen((out + ".summary.csv").c_str(), "w");
+  if(runs == 0 || trace == 0 || summary == 0){
+    printf("Unable to write %s.*.csv\n", out.c_str());
+    exit(-1);
+  }
+  fprintf(runs, "instance,teams,seed,seconds,iterations,iterations_per_s,feasible,cost,best_known,gap_pct");
+  fprintf(summary, "instance,teams,status,runs,feasible_rate,best_cost,mean_cost,mean_iterations_per_s");
+  for (unsigned x = 0; x < within.size(); x++) {
+    fprintf(runs, ",t_within_%g", within[x]);
+    fprintf(summary, ",rate_within_%g,mean_t_within_%g", within[x], within[x]);
+  }
+  fprintf(runs, "\n");
+  fprintf(summary, "\n");
+  fprintf(trace, "instance,seed,seconds,cost\n");
+
+  for (const instance &in : suite) {
+    std::vector<dst_t> M = in.circ ? circMatrix(in.teams) : loadNL(dir, in);
+    int feasible = 0;
+    unsigned bestCost = 0;
+    double sumCost = 0, sumRate = 0;
+    std::vector<int> reached(within.size(), 0);
+    std::vector<double> sumTime(within.size(), 0);
+
+    if(M.empty()){
+      printf("%s: not found in %s, skipped\n", in.name, dir.c_str());
+      fprintf(summary, "%s,%d,missing,0,,,,", in.name, in.teams);
+      for (unsigned x = 0; x < within.size(); x++) {
+        fprintf(summary, ",,");
+      }
+      fprintf(summary, "\n");
+      skipped++;
+      continue;
+    }
+    for (int s = 0; s < seedCount; s++) {
+      ttp inst(M);
+      inst.setVerbose(false);
+      inst.seed(seeds[s]);
+      inst.randomSchedule();
+      auto start = std::chrono::steady_clock::now();
+      unsigned cost = inst.ttsa_optimization(in.best, limit);
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      const std::vector < std::pair <double,unsigned> > &p = inst.progress();
+      double rate = (elapsed.count() > 0) ? inst.iterations()/elapsed.count() : 0;
+      bool valid = !p.empty();
+
+      sumRate += rate;
+      fprintf(runs, "%s,%d,%u,%.3f,%llu,%.0f,%d,", in.name, in.teams, seeds[s], elapsed.count(), inst.iterations(), rate, valid);
+      if(valid){
+        feasible++;
+        sumCost += cost;
+        bestCost = (bestCost == 0 || cost < bestCost) ? cost : bestCost;
+        fprintf(runs, "%u", cost);
+      }
+      fprintf(runs, ",");
+      if(in.best > 0){
+        fprintf(runs, "%u", in.best);
+      }
+      fprintf(runs, ",");
+      if(in.best > 0 && valid){
+        fprintf(runs, "%.3f", 100.0*((double) cost - in.best)/in.best);
+      }
+      for (unsigned x = 0; x < within.size(); x++) {
+        fprintf(runs, ",");
+        for (unsigned k = 0; in.best > 0 && k < p.size(); k++) {
+          if(p[k].second <= in.best*(1 + within[x]/100)){
+            fprintf(runs, "%.3f", p[k].first);
+            reached[x]++;
+            sumTime[x] += p[k].first;
+            break;
+          }
+        }
+      }
+      fprintf(runs, "\n");
+      for (unsigned k = 0; k < p.size(); k++) {
+        fprintf(trace, "%s,%u,%.3f,%u\n", in.name, seeds[s], p[k].first, p[k].second);
+      }
+      printf("%s seed %u: %s %u in %.2f s\n", in.name, seeds[s], valid ? "cost" : "no valid schedule,", valid ? cost : 0, elapsed.count());
+      fflush(stdout);
+    }
+
+    fprintf(summary, "%s,%d,run,%d,%.3f,", in.name, in.teams, seedCount, (double) feasible/seedCount);
+    if(feasible > 0){
+      fprintf(summary, "%u,%.1f", bestCost, sumCost/feasible);
+    }
+    else{
+      fprintf(summary, ",");
+    }
+    fprintf(summary, ",%.0f", sumRate/seedCount);
+    for (unsigned x = 0; x < within.size(); x++) {
+      fprintf(summary, ",");
+      if(in.best > 0){
+        fprintf(summary, "%.3f", (double) reached[x]/seedCount);
+      }
+      fprintf(summary, ",");
+      if(reached[x] > 0){
+        fprintf(summary, "%.3f", sumTime[x]/reached[x]);
+      }
+    }
+    fprintf(summary, "\n");
+  }
+
+  fclose(runs);
+  fclose(trace);
+  fclose(summary);
+  if(skipped > 0){
+    printf("%d instance(s) not found in %s were skipped (see %s.summary.csv)\n", skipped, dir.c_str(), out.c_str());
+  }
+  return 0;
+}
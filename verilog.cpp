@@ -0,0 +1,1609 @@
+//============================================================================
+// Name        : verilog.cpp
+// Author      : Devang Khamar
+// Version     : 1.x
+// Copyright   : N/A
+// Description : Verilog front end of ROBDDs.cpp: parses the synthesizable
+//				 subset used by Lab3 and lowers it into a shared bddManager
+//				 ("ROBDDs verilog"). Not built on its own: ROBDDs.cpp
+//				 includes it after bddManager and bitVector, like it does
+//				 Lab3/booth_sim.cpp.
+//============================================================================
+
+enum vlogExprKind {VX_ID, VX_NUM, VX_UNARY, VX_BINARY, VX_TERNARY, VX_CONCAT, VX_REPEAT, VX_SELECT};
+enum vlogStmtKind {VS_BLOCK, VS_ASSIGN, VS_IF, VS_CASE};
+enum vlogDriver {DRV_ASSIGN, DRV_BLOCK, DRV_INSTANCE};
+
+struct vlogExpr{
+	/*
+	 * Node of a Verilog expression. op holds the operator or the identifier, a literal
+	 * keeps its bits (least significant first) in value, and a select has the selected
+	 * identifier followed by the msb and lsb (or the single index) as arguments.
+	 */
+	int kind;
+	std::string op;
+	std::vector<bool> value;
+	std::vector<vlogExpr*> args;
+};
+
+struct vlogStmt{
+	/*
+	 * Statement of an always block. An if has its condition in cond and body = {then, else}
+	 * (else may be NULL). A case has its selector in cond, and item k is body[k] with the
+	 * labels labels[k] (none for the default item).
+	 */
+	int kind;
+	vlogExpr *lhs, *rhs, *cond;
+	std::vector<vlogStmt*> body;
+	std::vector<std::vector<vlogExpr*> > labels;
+};
+
+struct vlogNet{
+	unsigned width;
+	int lsb;
+	int dir;								// 0 wire/reg, 1 input, 2 output
+};
+
+struct vlogInstance{
+	std::string module, name;
+	std::vector<std::string> formals;		// ports of named connections, empty if positional
+	std::vector<vlogExpr*> actuals;			// NULL for an unconnected port
+};
+
+struct vlogAssert{
+	std::string label, text;
+	vlogExpr *ante, *cons;					// both NULL for a sequential property
+};
+
+struct vlogModule{
+	std::string name;
+	std::vector<std::string> ports, decls;
+	std::map<std::string, vlogNet> nets;
+	std::map<std::string, vlogExpr*> params;
+	std::vector<std::pair<vlogExpr*, vlogExpr*> > assigns;
+	std::vector<vlogStmt*> blocks;			// bodies of the always @* blocks
+	std::vector<std::string> registers;		// nets assigned by clocked always blocks
+	std::vector<vlogInstance> instances;
+	std::vector<vlogAssert> asserts;
+	std::map<std::string, std::pair<int,int> > drivers;	// net -> (vlogDriver, index)
+};
+
+bool vlogConst(vlogModule *mod, vlogExpr *e, long long &v, int depth = 0){
+	/*
+	 * Evaluates a constant expression (literals and parameters combined with + - *),
+	 * as used by ranges, selects and replication counts.
+	 */
+	long long a, b;
+	if(depth > 32){
+		return false;
+	}
+	switch(e->kind){
+	case VX_NUM:
+		v = 0;
+		for(unsigned k = 0; k < e->value.size() && k < 63; k++){
+			v |= (long long)e->value[k] << k;
+		}
+		return true;
+	case VX_ID:
+		return mod->params.count(e->op) != 0 && vlogConst(mod, mod->params[e->op], v, depth + 1);
+	case VX_UNARY:
+		if(e->op != "-" || !vlogConst(mod, e->args[0], a, depth + 1)){
+			return false;
+		}
+		v = -a;
+		return true;
+	case VX_BINARY:
+		if(!vlogConst(mod, e->args[0], a, depth + 1) || !vlogConst(mod, e->args[1], b, depth + 1)){
+			return false;
+		}
+		if(e->op == "+"){
+			v = a + b;
+		}
+		else if(e->op == "-"){
+			v = a - b;
+		}
+		else if(e->op == "*"){
+			v = a * b;
+		}
+		else{
+			return false;
+		}
+		return true;
+	}
+	return false;
+}
+
+void vlogAssigned(vlogStmt *s, std::vector<std::string> &names){
+	/*
+	 * Collects the nets assigned anywhere in s, each once.
+	 */
+	if(s == NULL){
+		return;
+	}
+	if(s->kind == VS_ASSIGN){
+		if(std::find(names.begin(), names.end(), s->lhs->op) == names.end()){
+			names.push_back(s->lhs->op);
+		}
+		return;
+	}
+	for(unsigned k = 0; k < s->body.size(); k++){
+		vlogAssigned(s->body[k], names);
+	}
+}
+
+class verilogParser{
+	/*
+	 * Recursive descent parser for the synthesizable Verilog subset of Lab3: ANSI or
+	 * plain port lists, wire/reg declarations, parameters, continuous assignments,
+	 * always @* blocks with begin/end, if/else and case, module instances and labelled
+	 * assert property items. Clocked always blocks are only scanned for the registers
+	 * they assign, and properties using |=>, ## or a clocking event are kept as text.
+	 * Expressions cover ~ ! - and the reductions & | ^, * + - == != & ^ | && ||, ?:,
+	 * concatenation, replication, bit and part selects, and sized or decimal literals.
+	 *
+	 * On an error, error holds the message with its line number and parse() returns false.
+	 */
+	struct vlogToken{
+		std::string text;
+		int line;
+		bool spaced;					// preceded by white space or a comment
+	};
+	std::vector<vlogToken> toks;
+	size_t pos;
+	vlogModule *cur;
+	std::vector<vlogExpr*> exprs;
+	std::vector<vlogStmt*> stmts;
+
+	const std::string &peek(unsigned ahead = 0){
+		static const std::string none;
+		return (pos + ahead < toks.size()) ? toks[pos + ahead].text : none;
+	}
+
+	bool accept(const char *t){
+		if(pos < toks.size() && toks[pos].text == t){
+			pos++;
+			return true;
+		}
+		return false;
+	}
+
+	bool fail(const std::string &msg){
+		if(error.empty()){
+			int line = toks.empty() ? 0 : toks[std::min(pos, toks.size() - 1)].line;
+			error = "line " + std::to_string(line) + ": " + msg;
+		}
+		return false;
+	}
+
+	bool expect(const char *t){
+		if(accept(t)){
+			return true;
+		}
+		return fail(std::string("expected '") + t + "' before '" + peek() + "'");
+	}
+
+	static bool isIdent(const std::string &t){
+		return !t.empty() && (isalpha(t[0]) || t[0] == '_');
+	}
+
+	vlogExpr *mkExpr(int kind, const std::string &op, vlogExpr *a = NULL, vlogExpr *b = NULL, vlogExpr *c = NULL){
+		vlogExpr *e = new vlogExpr;
+		exprs.push_back(e);
+		e->kind = kind;
+		e->op = op;
+		if(a != NULL){
+			e->args.push_back(a);
+		}
+		if(b != NULL){
+			e->args.push_back(b);
+		}
+		if(c != NULL){
+			e->args.push_back(c);
+		}
+		return e;
+	}
+
+	vlogStmt *mkStmt(int kind){
+		vlogStmt *s = new vlogStmt;
+		stmts.push_back(s);
+		s->kind = kind;
+		s->lhs = s->rhs = s->cond = NULL;
+		return s;
+	}
+
+	void lex(const std::string &src){
+		static const char *ops[] = {"|->", "|=>", "===", "!==", "==", "!=", "&&", "||", "<=", ">=", "##", NULL};
+		size_t i = 0, s, n = src.size();
+		int line = 1, k;
+		bool spaced = false;
+
+		while(i < n){
+			if(src[i] == '\n'){
+				line++;
+				i++;
+				spaced = true;
+				continue;
+			}
+			if(isspace(src[i])){
+				i++;
+				spaced = true;
+				continue;
+			}
+			if(src[i] == '`' || src.compare(i, 2, "//") == 0){
+				/* comments and compiler directives run to the end of the line */
+				while(i < n && src[i] != '\n'){
+					i++;
+				}
+				spaced = true;
+				continue;
+			}
+			if(src.compare(i, 2, "/*") == 0){
+				for(i += 2; i < n && src.compare(i, 2, "*/") != 0; i++){
+					line += (src[i] == '\n');
+				}
+				i += 2;
+				spaced = true;
+				continue;
+			}
+			s = i;
+			if(isalpha(src[i]) || src[i] == '_' || src[i] == '$'){
+				while(i < n && (isalnum(src[i]) || src[i] == '_' || src[i] == '$')){
+					i++;
+				}
+			}
+			else if(isdigit(src[i]) || src[i] == '\''){
+				while(i < n && (isalnum(src[i]) || src[i] == '_' || src[i] == '\'')){
+					i++;
+				}
+			}
+			else{
+				for(k = 0; ops[k] != NULL && src.compare(i, strlen(ops[k]), ops[k]) != 0; k++);
+				i += (ops[k] != NULL) ? strlen(ops[k]) : 1;
+			}
+			toks.push_back({src.substr(s, i - s), line, spaced});
+			spaced = false;
+		}
+	}
+
+	vlogExpr *number(const std::string &t){
+		/*
+		 * <width>'<base><digits> or a plain decimal (32 bits). x and z digits are rejected.
+		 */
+		vlogExpr *e = mkExpr(VX_NUM, t);
+		size_t q = t.find('\''), b;
+		unsigned width = 32, radix = 10, d, x, carry;
+		std::string digits = t;
+
+		if(q != std::string::npos){
+			if(q > 0){
+				width = atoi(t.substr(0, q).c_str());
+			}
+			b = q + 1;
+			if(b < t.size() && tolower(t[b]) == 's'){
+				b++;
+			}
+			switch(b < t.size() ? tolower(t[b]) : 0){
+			case 'b': radix = 2; break;
+			case 'o': radix = 8; break;
+			case 'd': radix = 10; break;
+			case 'h': radix = 16; break;
+			default: fail("malformed literal '" + t + "'"); return NULL;
+			}
+			digits = t.substr(b + 1);
+		}
+		if(width == 0 || width > 4096 || digits.empty()){
+			fail("malformed literal '" + t + "'");
+			return NULL;
+		}
+		e->value.assign(width, false);
+		for(unsigned k = 0; k < digits.size(); k++){
+			if(digits[k] == '_'){
+				continue;
+			}
+			d = isdigit(digits[k]) ? digits[k] - '0' : isxdigit(digits[k]) ? tolower(digits[k]) - 'a' + 10 : 99;
+			if(d >= radix){
+				fail("unsupported digit in literal '" + t + "'");
+				return NULL;
+			}
+			/* value = value * radix + d, one bit at a time */
+			carry = d;
+			for(unsigned j = 0; j < width; j++){
+				x = e->value[j] * radix + carry;
+				e->value[j] = x & 1;
+				carry = x >> 1;
+			}
+		}
+		return e;
+	}
+
+	vlogExpr *concat(vlogExpr *first){
+		/*
+		 * Rest of {first, ...} after the first item.
+		 */
+		vlogExpr *e = mkExpr(VX_CONCAT, "{}", first), *a;
+		while(accept(",")){
+			if((a = expression()) == NULL){
+				return NULL;
+			}
+			e->args.push_back(a);
+		}
+		return expect("}") ? e : NULL;
+	}
+
+	vlogExpr *primary(){
+		std::string t = peek();
+		vlogExpr *e, *a;
+
+		if(accept("(")){
+			e = expression();
+			return (e != NULL && expect(")")) ? e : NULL;
+		}
+		if(accept("{")){
+			if((a = expression()) == NULL){
+				return NULL;
+			}
+			if(!accept("{")){
+				return concat(a);
+			}
+			/* replication {n{...}} */
+			e = expression();
+			if(e == NULL || (e = concat(e)) == NULL || !expect("}")){
+				return NULL;
+			}
+			return mkExpr(VX_REPEAT, "{}", a, e);
+		}
+		if(!t.empty() && (isdigit(t[0]) || t[0] == '\'')){
+			pos++;
+			return number(t);
+		}
+		if(!isIdent(t)){
+			fail("unexpected '" + t + "'");
+			return NULL;
+		}
+		pos++;
+		e = mkExpr(VX_ID, t);
+		if(!accept("[")){
+			return e;
+		}
+		e = mkExpr(VX_SELECT, t, e);
+		if((a = expression()) == NULL){
+			return NULL;
+		}
+		e->args.push_back(a);
+		if(accept(":")){
+			if((a = expression()) == NULL){
+				return NULL;
+			}
+			e->args.push_back(a);
+		}
+		return expect("]") ? e : NULL;
+	}
+
+	vlogExpr *unary(){
+		std::string op = peek();
+		vlogExpr *a;
+		if(op == "~" || op == "!" || op == "-" || op == "+" || op == "&" || op == "|" || op == "^"){
+			pos++;
+			if((a = unary()) == NULL){
+				return NULL;
+			}
+			return (op == "+") ? a : mkExpr(VX_UNARY, op, a);
+		}
+		return primary();
+	}
+
+	vlogExpr *binary(int level){
+		/*
+		 * Binary operators by increasing precedence, all left associative.
+		 */
+		static const char *ops[][4] = {{"||"}, {"&&"}, {"|"}, {"^"}, {"&"}, {"==", "!=", "===", "!=="},
+									   {"+", "-"}, {"*"}};
+		vlogExpr *l, *r;
+		int k;
+
+		if(level == 8){
+			return unary();
+		}
+		l = binary(level + 1);
+		while(l != NULL){
+			for(k = 0; k < 4 && ops[level][k] != NULL && peek() != ops[level][k]; k++);
+			if(k == 4 || ops[level][k] == NULL){
+				break;
+			}
+			pos++;
+			if((r = binary(level + 1)) == NULL){
+				return NULL;
+			}
+			/* two-valued logic: === and !== are == and != */
+			l = mkExpr(VX_BINARY, std::string(ops[level][k]).substr(0, 2), l, r);
+		}
+		return l;
+	}
+
+	vlogExpr *expression(){
+		vlogExpr *c = binary(0), *a, *b;
+		if(c == NULL || !accept("?")){
+			return c;
+		}
+		if((a = expression()) == NULL || !expect(":") || (b = expression()) == NULL){
+			return NULL;
+		}
+		return mkExpr(VX_TERNARY, "?", c, a, b);
+	}
+
+	vlogExpr *lvalue(){
+		vlogExpr *e = primary();
+		if(e != NULL && e->kind != VX_ID && e->kind != VX_SELECT){
+			fail("unsupported assignment target");
+			return NULL;
+		}
+		return e;
+	}
+
+	vlogStmt *statement(){
+		vlogStmt *s, *a, *b = NULL;
+		vlogExpr *l;
+
+		if(accept(";")){
+			return mkStmt(VS_BLOCK);
+		}
+		if(accept("begin")){
+			s = mkStmt(VS_BLOCK);
+			if(accept(":")){
+				pos++;		// block name
+			}
+			while(!accept("end")){
+				if(pos >= toks.size()){
+					fail("missing 'end'");
+					return NULL;
+				}
+				if((a = statement()) == NULL){
+					return NULL;
+				}
+				s->body.push_back(a);
+			}
+			return s;
+		}
+		if(accept("if")){
+			s = mkStmt(VS_IF);
+			if(!expect("(") || (s->cond = expression()) == NULL || !expect(")") || (a = statement()) == NULL){
+				return NULL;
+			}
+			if(accept("else") && (b = statement()) == NULL){
+				return NULL;
+			}
+			s->body.push_back(a);
+			s->body.push_back(b);
+			return s;
+		}
+		if(accept("case")){
+			s = mkStmt(VS_CASE);
+			if(!expect("(") || (s->cond = expression()) == NULL || !expect(")")){
+				return NULL;
+			}
+			while(!accept("endcase")){
+				std::vector<vlogExpr*> labels;
+				if(pos >= toks.size()){
+					fail("missing 'endcase'");
+					return NULL;
+				}
+				if(accept("default")){
+					accept(":");
+				}
+				else{
+					do{
+						if((l = expression()) == NULL){
+							return NULL;
+						}
+						labels.push_back(l);
+					} while(accept(","));
+					if(!expect(":")){
+						return NULL;
+					}
+				}
+				if((a = statement()) == NULL){
+					return NULL;
+				}
+				s->labels.push_back(labels);
+				s->body.push_back(a);
+			}
+			return s;
+		}
+		s = mkStmt(VS_ASSIGN);
+		if((s->lhs = lvalue()) == NULL || (!accept("=") && !expect("<="))){
+			return NULL;
+		}
+		if((s->rhs = expression()) == NULL || !expect(";")){
+			return NULL;
+		}
+		return s;
+	}
+
+	bool range(unsigned &width, int &lsb){
+		/*
+		 * Optional [msb:lsb] of a declaration, a single bit if absent.
+		 */
+		vlogExpr *h, *l;
+		long long hv, lv;
+
+		width = 1;
+		lsb = 0;
+		if(!accept("[")){
+			return true;
+		}
+		if((h = expression()) == NULL || !expect(":") || (l = expression()) == NULL || !expect("]")){
+			return false;
+		}
+		if(!vlogConst(cur, h, hv) || !vlogConst(cur, l, lv)){
+			return fail("range bounds must be constant");
+		}
+		if(hv < lv || hv - lv >= 4096){
+			return fail("only descending ranges of up to 4096 bits are supported");
+		}
+		width = hv - lv + 1;
+		lsb = lv;
+		return true;
+	}
+
+	bool declare(const std::string &name, unsigned width, int lsb, int dir){
+		/*
+		 * Declares a net. A port may be declared twice (e.g. "output x;" then "reg [3:0] x;").
+		 */
+		std::map<std::string, vlogNet>::iterator it = cur->nets.find(name);
+		if(it == cur->nets.end()){
+			cur->nets[name] = {width, lsb, dir};
+			cur->decls.push_back(name);
+			return true;
+		}
+		if(dir != 0){
+			it->second.dir = dir;
+		}
+		if(width > 1 || lsb != 0){
+			it->second.width = width;
+			it->second.lsb = lsb;
+		}
+		return true;
+	}
+
+	int direction(){
+		if(accept("input")){
+			return 1;
+		}
+		if(accept("output")){
+			return 2;
+		}
+		if(peek() == "inout"){
+			fail("inout ports are not supported");
+			return -1;
+		}
+		return 0;
+	}
+
+	bool netType(){
+		accept("wire") || accept("reg") || accept("logic");
+		if(peek() == "signed"){
+			return fail("signed nets are not supported");
+		}
+		return true;
+	}
+
+	bool portList(){
+		int dir = 0, lsb = 0;
+		unsigned width = 1;
+		std::string name;
+
+		if(accept(")")){
+			return true;
+		}
+		do{
+			if(peek() == "input" || peek() == "output" || peek() == "inout"){
+				if((dir = direction()) < 0 || !netType() || !range(width, lsb)){
+					return false;
+				}
+			}
+			name = peek();
+			if(!isIdent(name)){
+				return fail("expected a port name");
+			}
+			pos++;
+			cur->ports.push_back(name);
+			if(dir != 0){
+				declare(name, width, lsb, dir);
+			}
+		} while(accept(","));
+		return expect(")");
+	}
+
+	bool declaration(){
+		int dir = direction(), lsb;
+		unsigned width;
+		std::string name;
+		vlogExpr *r;
+
+		if(dir < 0 || !netType() || !range(width, lsb)){
+			return false;
+		}
+		do{
+			name = peek();
+			if(!isIdent(name)){
+				return fail("expected a net name");
+			}
+			pos++;
+			declare(name, width, lsb, dir);
+			if(accept("=")){
+				if((r = expression()) == NULL){
+					return false;
+				}
+				cur->assigns.push_back(std::make_pair(mkExpr(VX_ID, name), r));
+			}
+		} while(accept(","));
+		return expect(";");
+	}
+
+	bool parameters(){
+		unsigned width;
+		int lsb;
+		long long v;
+		std::string name;
+		vlogExpr *e;
+
+		do{
+			accept("parameter");
+			if(!range(width, lsb)){
+				return false;
+			}
+			name = peek();
+			if(!isIdent(name)){
+				return fail("expected a parameter name");
+			}
+			pos++;
+			if(!expect("=") || (e = expression()) == NULL){
+				return false;
+			}
+			cur->params[name] = e;
+			if(!vlogConst(cur, e, v)){
+				return fail("parameter " + name + " must be constant");
+			}
+		} while(accept(","));
+		return true;
+	}
+
+	bool assertion(std::string label){
+		/*
+		 * [label:] assert property (...); with the property kept as text. Immediate
+		 * (a |-> b) and plain boolean properties are parsed, anything with |=>, ## or a
+		 * clocking event is left to the reachability engine.
+		 */
+		vlogAssert a;
+		size_t start, end;
+		int depth = 1;
+		bool sequential = false;
+
+		if(!expect("assert") || !expect("property") || !expect("(")){
+			return false;
+		}
+		for(start = end = pos; end < toks.size() && depth > 0; end++){
+			const std::string &x = toks[end].text;
+			depth += (x == "(") - (x == ")");
+			sequential |= (x == "|=>" || x == "##" || x == "@" || x[0] == '$');
+		}
+		if(depth > 0){
+			return fail("unterminated property");
+		}
+		for(size_t k = start; k + 1 < end; k++){
+			a.text += ((k > start && toks[k].spaced) ? " " : "") + toks[k].text;
+		}
+		a.label = label.empty() ? "assert_" + std::to_string(cur->asserts.size() + 1) : label;
+		a.ante = a.cons = NULL;
+		if(sequential){
+			pos = end;
+		}
+		else{
+			if((a.cons = expression()) == NULL){
+				return false;
+			}
+			if(accept("|->")){
+				a.ante = a.cons;
+				if((a.cons = expression()) == NULL){
+					return false;
+				}
+			}
+			else{
+				a.ante = mkExpr(VX_NUM, "1'b1");
+				a.ante->value.assign(1, true);
+			}
+			if(!expect(")")){
+				return false;
+			}
+		}
+		cur->asserts.push_back(a);
+		return expect(";");
+	}
+
+	bool instance(){
+		vlogInstance in;
+		vlogExpr *a;
+
+		in.module = peek();
+		pos++;
+		if(peek() == "#"){
+			return fail("parameter overrides are not supported");
+		}
+		in.name = peek();
+		if(!isIdent(in.name)){
+			return fail("expected an instance name");
+		}
+		pos++;
+		if(!expect("(")){
+			return false;
+		}
+		if(!accept(")")){
+			do{
+				a = NULL;
+				if(accept(".")){
+					in.formals.push_back(peek());
+					pos++;
+					if(!expect("(")){
+						return false;
+					}
+					if(!accept(")") && ((a = expression()) == NULL || !expect(")"))){
+						return false;
+					}
+				}
+				else if(!in.formals.empty() || (a = expression()) == NULL){
+					return fail("mixed or malformed port connections");
+				}
+				in.actuals.push_back(a);
+			} while(accept(","));
+			if(!expect(")")){
+				return false;
+			}
+		}
+		cur->instances.push_back(in);
+		return expect(";");
+	}
+
+	bool item(){
+		std::string t = peek(), label;
+		vlogStmt *s;
+		bool clocked;
+		int depth;
+
+		if(t == "input" || t == "output" || t == "inout" || t == "wire" || t == "reg" || t == "logic"){
+			return declaration();
+		}
+		if(accept("parameter") || accept("localparam")){
+			return parameters() && expect(";");
+		}
+		if(accept("assign")){
+			do{
+				vlogExpr *l = lvalue(), *r;
+				if(l == NULL || !expect("=") || (r = expression()) == NULL){
+					return false;
+				}
+				cur->assigns.push_back(std::make_pair(l, r));
+			} while(accept(","));
+			return expect(";");
+		}
+		if(accept("always") || accept("always_comb") || accept("always_ff")){
+			clocked = (t == "always_ff");
+			if(t != "always_comb"){
+				if(!expect("@")){
+					return false;
+				}
+				if(!accept("*")){
+					if(!expect("(")){
+						return false;
+					}
+					for(depth = 1; depth > 0; pos++){
+						if(pos >= toks.size()){
+							return fail("unterminated sensitivity list");
+						}
+						depth += (peek() == "(") - (peek() == ")");
+						clocked |= (peek() == "posedge" || peek() == "negedge");
+					}
+				}
+			}
+			if((s = statement()) == NULL){
+				return false;
+			}
+			if(clocked){
+				vlogAssigned(s, cur->registers);
+			}
+			else{
+				cur->blocks.push_back(s);
+			}
+			return true;
+		}
+		if(accept("initial")){
+			return statement() != NULL;
+		}
+		if(isIdent(t) && peek(1) == ":"){
+			label = t;
+			pos += 2;
+		}
+		if(peek() == "assert"){
+			return assertion(label);
+		}
+		if(label.empty() && isIdent(t) && (isIdent(peek(1)) || peek(1) == "#")){
+			return instance();
+		}
+		return fail("unsupported construct '" + peek() + "'");
+	}
+
+	bool module(){
+		cur = new vlogModule;
+		cur->name = peek();
+		order.push_back(cur);
+		if(!isIdent(cur->name)){
+			return fail("expected a module name");
+		}
+		if(modules.count(cur->name) != 0){
+			return fail("module " + cur->name + " is defined twice");
+		}
+		modules[cur->name] = cur;
+		pos++;
+		if(accept("#") && (!expect("(") || !parameters() || !expect(")"))){
+			return false;
+		}
+		if(accept("(") && !portList()){
+			return false;
+		}
+		if(!expect(";")){
+			return false;
+		}
+		while(!accept("endmodule")){
+			if(pos >= toks.size()){
+				return fail("missing 'endmodule'");
+			}
+			if(!item()){
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool drive(vlogModule *mod, const std::string &name, int kind, int index){
+		if(mod->nets.count(name) == 0){
+			error = "module " + mod->name + ": undeclared net '" + name + "'";
+			return false;
+		}
+		if(mod->nets[name].dir == 1 || mod->drivers.count(name) != 0){
+			error = "module " + mod->name + ": net '" + name + "' has more than one driver";
+			return false;
+		}
+		mod->drivers[name] = std::make_pair(kind, index);
+		return true;
+	}
+
+	bool link(){
+		/*
+		 * Finds the driver of every net and resolves the module instances.
+		 */
+		for(unsigned i = 0; i < order.size(); i++){
+			vlogModule *mod = order[i];
+			for(unsigned k = 0; k < mod->ports.size(); k++){
+				if(mod->nets.count(mod->ports[k]) == 0 || mod->nets[mod->ports[k]].dir == 0){
+					error = "module " + mod->name + ": port '" + mod->ports[k] + "' has no direction";
+					return false;
+				}
+			}
+			for(unsigned k = 0; k < mod->assigns.size(); k++){
+				if(mod->assigns[k].first->kind != VX_ID){
+					error = "module " + mod->name + ": continuous assignment to part of '" +
+							mod->assigns[k].first->op + "' is not supported";
+					return false;
+				}
+				if(!drive(mod, mod->assigns[k].first->op, DRV_ASSIGN, k)){
+					return false;
+				}
+			}
+			for(unsigned k = 0; k < mod->blocks.size(); k++){
+				std::vector<std::string> names;
+				vlogAssigned(mod->blocks[k], names);
+				for(unsigned j = 0; j < names.size(); j++){
+					if(!drive(mod, names[j], DRV_BLOCK, k)){
+						return false;
+					}
+				}
+			}
+			for(unsigned k = 0; k < mod->registers.size(); k++){
+				if(mod->nets.count(mod->registers[k]) == 0 || mod->drivers.count(mod->registers[k]) != 0){
+					error = "module " + mod->name + ": bad register '" + mod->registers[k] + "'";
+					return false;
+				}
+			}
+			for(unsigned k = 0; k < mod->instances.size(); k++){
+				vlogInstance &in = mod->instances[k];
+				if(modules.count(in.module) == 0){
+					error = "module " + mod->name + ": unknown module '" + in.module + "'";
+					return false;
+				}
+				vlogModule *sub = modules[in.module];
+				if(in.formals.empty()){
+					if(in.actuals.size() > sub->ports.size()){
+						error = "module " + mod->name + ": too many connections to " + in.name;
+						return false;
+					}
+					in.formals.assign(sub->ports.begin(), sub->ports.begin() + in.actuals.size());
+				}
+				for(unsigned j = 0; j < in.formals.size(); j++){
+					if(sub->nets.count(in.formals[j]) == 0 || sub->nets[in.formals[j]].dir == 0){
+						error = "module " + mod->name + ": " + in.module + " has no port '" + in.formals[j] + "'";
+						return false;
+					}
+					if(sub->nets[in.formals[j]].dir != 2 || in.actuals[j] == NULL){
+						continue;
+					}
+					if(in.actuals[j]->kind != VX_ID){
+						error = "module " + mod->name + ": output " + in.formals[j] + " of " + in.name +
+								" must be connected to a whole net";
+						return false;
+					}
+					if(!drive(mod, in.actuals[j]->op, DRV_INSTANCE, k)){
+						return false;
+					}
+				}
+			}
+		}
+		return true;
+	}
+
+public:
+	std::string error;
+	std::map<std::string, vlogModule*> modules;
+	std::vector<vlogModule*> order;		// modules in file order
+
+	~verilogParser(){
+		for(unsigned k = 0; k < exprs.size(); k++){
+			delete exprs[k];
+		}
+		for(unsigned k = 0; k < stmts.size(); k++){
+			delete stmts[k];
+		}
+		for(unsigned k = 0; k < order.size(); k++){
+			delete order[k];
+		}
+	}
+
+	bool parse(const char *path){
+		std::string src;
+		char buf[4096];
+		size_t n;
+		FILE *fi = fopen(path, "r");
+
+		if(fi == NULL){
+			error = std::string("cannot open ") + path;
+			return false;
+		}
+		while((n = fread(buf, 1, sizeof(buf), fi)) > 0){
+			src.append(buf, n);
+		}
+		fclose(fi);
+		lex(src);
+		pos = 0;
+		while(pos < toks.size()){
+			if(!expect("module") || !module()){
+				return false;
+			}
+		}
+		return link();
+	}
+
+	unsigned freeBits(vlogModule *mod, bool top, int depth = 0){
+		/*
+		 * Upper bound on the variables needed to lower mod: its undriven nets (and its
+		 * inputs if it is the top module), plus those of the modules it instantiates.
+		 */
+		unsigned n = 0;
+		std::map<std::string, vlogNet>::iterator it;
+		if(depth > 64){
+			return 0;
+		}
+		for(it = mod->nets.begin(); it != mod->nets.end(); it++){
+			if((it->second.dir != 1 || top) && mod->drivers.count(it->first) == 0){
+				n += it->second.width;
+			}
+		}
+		for(unsigned k = 0; k < mod->instances.size(); k++){
+			n += freeBits(modules[mod->instances[k].module], false, depth + 1);
+		}
+		return n;
+	}
+};
+
+class verilogLowering{
+	/*
+	 * Lowers modules of a verilogParser into one shared manager, a bit-vector per net,
+	 * and checks their immediate assertions as implications. Nets are lowered on demand
+	 * from their driver (continuous assignment, always @* block or instance), so only the
+	 * cone of an assertion is built, and instances are flattened. Inputs of the top
+	 * module, registers and undriven nets become free variables; those of the top module
+	 * are interleaved by bit position (a0 b0 a1 b1 ...), which keeps adders and
+	 * comparators linear. Operands are zero-extended to the width of their context, as
+	 * in Verilog; the net assigned by an always block reads as 0 until it is assigned.
+	 * An assertion whose cone reads a register states an invariant of the reachable
+	 * states, which is left to the reachability engine ("reach").
+	 */
+	typedef bitVector::bvec bvec;
+	typedef std::map<std::string, bvec> env;
+
+	struct scope{
+		vlogModule *mod;
+		env value;
+		std::map<std::string, int> state;	// 1 while being lowered, 2 once lowered
+		std::vector<int> instState;
+		env *local;							// nets of the always block being lowered
+		int depth;
+	};
+
+	bddManager &m;
+	bitVector bv;
+	std::map<std::string, vlogModule*> &modules;
+	unsigned nextVar, maxVars;
+
+	void fail(scope &s, const std::string &msg){
+		if(error.empty()){
+			error = "module " + s.mod->name + ": " + msg;
+		}
+	}
+
+	bvec fresh(scope &s, unsigned width){
+		bvec r(width, BDD_FALSE);
+		for(unsigned k = 0; k < width; k++){
+			if(nextVar >= maxVars){
+				fail(s, "out of variables");
+				break;
+			}
+			r[k] = m.ithVar(++nextVar);
+		}
+		return r;
+	}
+
+	unsigned any(const bvec &a){
+		unsigned r = BDD_FALSE;
+		for(unsigned k = 0; k < a.size(); k++){
+			r = m.Apply(OR, r, a[k]);
+		}
+		return r;
+	}
+
+	bool bounds(scope &s, vlogExpr *sel, unsigned &hi, unsigned &lo){
+		/*
+		 * Bit positions (from 0) of the constant select sel of a net.
+		 */
+		long long h, l;
+		vlogNet &n = s.mod->nets[sel->op];
+		if(!vlogConst(s.mod, sel->args[1], h) || !vlogConst(s.mod, sel->args.back(), l)){
+			fail(s, "non-constant select of " + sel->op);
+			return false;
+		}
+		h -= n.lsb;
+		l -= n.lsb;
+		if(l < 0 || h < l || h >= (long long)n.width){
+			fail(s, "select out of range of " + sel->op);
+			return false;
+		}
+		hi = h;
+		lo = l;
+		return true;
+	}
+
+	unsigned width(scope &s, vlogExpr *e){
+		/*
+		 * Self-determined width of e.
+		 */
+		unsigned w = 0, hi, lo;
+		long long n;
+		switch(e->kind){
+		case VX_ID:
+			if(s.mod->params.count(e->op) != 0){
+				return width(s, s.mod->params[e->op]);
+			}
+			return (s.mod->nets.count(e->op) != 0) ? s.mod->nets[e->op].width : 1;
+		case VX_NUM:
+			return e->value.size();
+		case VX_SELECT:
+			if(e->args.size() == 2 || s.mod->nets.count(e->op) == 0 || !bounds(s, e, hi, lo)){
+				return 1;
+			}
+			return hi - lo + 1;
+		case VX_UNARY:
+			return (e->op == "~" || e->op == "-") ? width(s, e->args[0]) : 1;
+		case VX_BINARY:
+			if(e->op == "==" || e->op == "!=" || e->op == "&&" || e->op == "||"){
+				return 1;
+			}
+			return std::max(width(s, e->args[0]), width(s, e->args[1]));
+		case VX_TERNARY:
+			return std::max(width(s, e->args[1]), width(s, e->args[2]));
+		case VX_CONCAT:
+			for(unsigned k = 0; k < e->args.size(); k++){
+				w += width(s, e->args[k]);
+			}
+			return w;
+		case VX_REPEAT:
+			if(!vlogConst(s.mod, e->args[0], n) || n < 0 || n > 4096){
+				return 1;
+			}
+			return n*width(s, e->args[1]);
+		}
+		return 1;
+	}
+
+	bvec eval(scope &s, vlogExpr *e, unsigned ctx){
+		/*
+		 * Lowers e at the width max(ctx, width(e)).
+		 */
+		unsigned w = std::max(ctx, width(s, e)), hi, lo, t;
+		long long n;
+		bvec r, a, b;
+
+		switch(e->kind){
+		case VX_ID:
+			if(s.mod->params.count(e->op) != 0){
+				r = eval(s, s.mod->params[e->op], 0);
+			}
+			else{
+				r = net(s, e->op);
+			}
+			break;
+		case VX_NUM:
+			for(unsigned k = 0; k < e->value.size(); k++){
+				r.push_back(e->value[k] ? BDD_TRUE : BDD_FALSE);
+			}
+			break;
+		case VX_SELECT:
+			if(s.mod->nets.count(e->op) == 0){
+				fail(s, "select of undeclared net '" + e->op + "'");
+			}
+			else if(bounds(s, e, hi, lo)){
+				r = bv.slice(net(s, e->op), hi, lo);
+			}
+			break;
+		case VX_UNARY:
+			if(e->op == "~"){
+				r = bv.bitNot(eval(s, e->args[0], w));
+			}
+			else if(e->op == "-"){
+				r = bv.neg(eval(s, e->args[0], w));
+			}
+			else if(e->op == "!" || e->op == "|"){
+				t = any(eval(s, e->args[0], 0));
+				r.push_back((e->op == "!") ? m.Not(t) : t);
+			}
+			else{
+				/* reduction & and ^ */
+				a = eval(s, e->args[0], 0);
+				t = (e->op == "&") ? BDD_TRUE : BDD_FALSE;
+				for(unsigned k = 0; k < a.size(); k++){
+					t = m.Apply((e->op == "&") ? AND : XOR, t, a[k]);
+				}
+				r.push_back(t);
+			}
+			break;
+		case VX_BINARY:
+			if(e->op == "==" || e->op == "!="){
+				t = std::max(width(s, e->args[0]), width(s, e->args[1]));
+				t = bv.equal(eval(s, e->args[0], t), eval(s, e->args[1], t));
+				r.push_back((e->op == "==") ? t : m.Not(t));
+				break;
+			}
+			if(e->op == "&&" || e->op == "||"){
+				t = any(eval(s, e->args[0], 0));
+				r.push_back(m.Apply((e->op == "&&") ? AND : OR, t, any(eval(s, e->args[1], 0))));
+				break;
+			}
+			a = eval(s, e->args[0], w);
+			b = eval(s, e->args[1], w);
+			if(e->op == "+"){
+				r = bv.add(a, b);
+			}
+			else if(e->op == "-"){
+				r = bv.sub(a, b);
+			}
+			else if(e->op == "*"){
+				r = bv.mul(a, b);
+			}
+			else{
+				r = bv.bitwise((e->op == "&") ? AND : (e->op == "|") ? OR : XOR, a, b);
+			}
+			break;
+		case VX_TERNARY:
+			t = any(eval(s, e->args[0], 0));
+			r = bv.mux(t, eval(s, e->args[1], w), eval(s, e->args[2], w));
+			break;
+		case VX_CONCAT:
+			r = eval(s, e->args.back(), 0);
+			for(int k = (int)e->args.size() - 2; k >= 0; k--){
+				r = bv.concat(eval(s, e->args[k], 0), r);
+			}
+			break;
+		case VX_REPEAT:
+			if(!vlogConst(s.mod, e->args[0], n) || n < 0 || n > 4096){
+				fail(s, "bad replication count");
+				break;
+			}
+			a = eval(s, e->args[1], 0);
+			for(long long k = 0; k < n; k++){
+				r = bv.concat(a, r);
+			}
+			break;
+		}
+		if(!error.empty()){
+			return bv.constant(w, 0);
+		}
+		return bv.resize(r, w, false);
+	}
+
+	void exec(scope &s, vlogStmt *st, env &vals){
+		/*
+		 * Symbolically executes st on the values of the nets of its always block.
+		 */
+		unsigned hi, lo, c, w;
+		bvec r;
+
+		if(st == NULL || !error.empty()){
+			return;
+		}
+		s.local = &vals;
+		switch(st->kind){
+		case VS_BLOCK:
+			for(unsigned k = 0; k < st->body.size(); k++){
+				exec(s, st->body[k], vals);
+			}
+			break;
+		case VS_ASSIGN:
+			w = s.mod->nets[st->lhs->op].width;
+			if(st->lhs->kind == VX_ID){
+				vals[st->lhs->op] = bv.resize(eval(s, st->rhs, w), w, false);
+			}
+			else if(bounds(s, st->lhs, hi, lo)){
+				r = bv.resize(eval(s, st->rhs, hi - lo + 1), hi - lo + 1, false);
+				for(unsigned k = lo; k <= hi; k++){
+					vals[st->lhs->op][k] = r[k - lo];
+				}
+			}
+			break;
+		case VS_IF:{
+			env t = vals, f = vals;
+			c = any(eval(s, st->cond, 0));
+			exec(s, st->body[0], t);
+			exec(s, st->body[1], f);
+			merge(c, t, f, vals);
+			break;
+		}
+		case VS_CASE:{
+			/* items are tried in order, so the first one sits on top of the mux chain */
+			std::vector<unsigned> match(st->body.size(), BDD_FALSE);
+			env acc = vals;
+			for(unsigned k = 0; k < st->body.size(); k++){
+				for(unsigned j = 0; j < st->labels[k].size(); j++){
+					w = std::max(width(s, st->cond), width(s, st->labels[k][j]));
+					match[k] = m.Apply(OR, match[k],
+									   bv.equal(eval(s, st->cond, w), eval(s, st->labels[k][j], w)));
+				}
+			}
+			for(unsigned k = 0; k < st->body.size(); k++){
+				if(st->labels[k].empty()){
+					exec(s, st->body[k], acc);
+				}
+			}
+			for(int k = (int)st->body.size() - 1; k >= 0; k--){
+				if(!st->labels[k].empty()){
+					env t = vals;
+					exec(s, st->body[k], t);
+					merge(match[k], t, acc, acc);
+				}
+			}
+			vals = acc;
+			break;
+		}
+		}
+		s.local = &vals;
+	}
+
+	void merge(unsigned c, env &t, env &f, env &r){
+		for(env::iterator it = t.begin(); it != t.end(); it++){
+			r[it->first] = bv.mux(c, it->second, f[it->first]);
+		}
+	}
+
+	void lowerBlock(scope &s, int b){
+		std::vector<std::string> names;
+		env vals;
+		vlogAssigned(s.mod->blocks[b], names);
+		for(unsigned k = 0; k < names.size(); k++){
+			s.state[names[k]] = 1;
+			vals[names[k]] = bv.constant(s.mod->nets[names[k]].width, 0);
+		}
+		exec(s, s.mod->blocks[b], vals);
+		s.local = NULL;
+		for(unsigned k = 0; k < names.size(); k++){
+			s.value[names[k]] = vals[names[k]];
+			s.state[names[k]] = 2;
+		}
+	}
+
+	void lowerInstance(scope &s, int i){
+		/*
+		 * Flattens instance i: lowers its inputs in s, then the outputs inside the
+		 * instantiated module, and copies them to the nets they are connected to.
+		 */
+		vlogInstance &in = s.mod->instances[i];
+		scope c;
+		c.mod = modules[in.module];
+		c.local = NULL;
+		c.depth = s.depth + 1;
+		c.instState.assign(c.mod->instances.size(), 0);
+		if(s.instState[i] != 0 || c.depth > 64){
+			fail(s, "combinational loop through instance " + in.name);
+			return;
+		}
+		s.instState[i] = 1;
+		for(unsigned k = 0; k < in.formals.size(); k++){
+			vlogNet &f = c.mod->nets[in.formals[k]];
+			if(f.dir == 1 && in.actuals[k] != NULL){
+				c.value[in.formals[k]] = bv.resize(eval(s, in.actuals[k], f.width), f.width, false);
+				c.state[in.formals[k]] = 2;
+			}
+		}
+		for(unsigned k = 0; k < in.formals.size() && error.empty(); k++){
+			if(c.mod->nets[in.formals[k]].dir == 2 && in.actuals[k] != NULL){
+				const std::string &name = in.actuals[k]->op;
+				s.value[name] = bv.resize(net(c, in.formals[k]), s.mod->nets[name].width, false);
+				s.state[name] = 2;
+			}
+		}
+		s.instState[i] = 2;
+	}
+
+	bool hasState(vlogModule *mod, int depth = 0){
+		if(!mod->registers.empty() || depth > 64){
+			return true;
+		}
+		for(unsigned k = 0; k < mod->instances.size(); k++){
+			if(hasState(modules[mod->instances[k].module], depth + 1)){
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool readsState(vlogModule *mod, vlogExpr *e, std::map<std::string, int> &memo){
+		/*
+		 * Whether the value of e depends on a register of mod (or of one of its instances).
+		 */
+		if(e == NULL){
+			return false;
+		}
+		if((e->kind == VX_ID || e->kind == VX_SELECT) && readsState(mod, e->op, memo)){
+			return true;
+		}
+		for(unsigned k = (e->kind == VX_SELECT) ? 1 : 0; k < e->args.size(); k++){
+			if(readsState(mod, e->args[k], memo)){
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool readsState(vlogModule *mod, vlogStmt *st, std::map<std::string, int> &memo){
+		if(st == NULL){
+			return false;
+		}
+		if(readsState(mod, st->rhs, memo) || readsState(mod, st->cond, memo)){
+			return true;
+		}
+		for(unsigned k = 0; k < st->body.size(); k++){
+			if(readsState(mod, st->body[k], memo)){
+				return true;
+			}
+			for(unsigned j = 0; k < st->labels.size() && j < st->labels[k].size(); j++){
+				if(readsState(mod, st->labels[k][j], memo)){
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	bool readsState(vlogModule *mod, const std::string &name, std::map<std::string, int> &memo){
+		/*
+		 * memo: 1 for a net being visited or found combinational, 2 for a net that reads state.
+		 */
+		std::map<std::string, std::pair<int,int> >::iterator d = mod->drivers.find(name);
+		bool r = false;
+		if(memo.count(name) != 0){
+			return memo[name] == 2;
+		}
+		memo[name] = 1;
+		if(std::find(mod->registers.begin(), mod->registers.end(), name) != mod->registers.end()){
+			r = true;
+		}
+		else if(d != mod->drivers.end() && d->second.first == DRV_ASSIGN){
+			r = readsState(mod, mod->assigns[d->second.second].second, memo);
+		}
+		else if(d != mod->drivers.end() && d->second.first == DRV_BLOCK){
+			r = readsState(mod, mod->blocks[d->second.second], memo);
+		}
+		else if(d != mod->drivers.end()){
+			vlogInstance &in = mod->instances[d->second.second];
+			r = hasState(modules[in.module]);
+			for(unsigned k = 0; k < in.actuals.size() && !r; k++){
+				if(modules[in.module]->nets[in.formals[k]].dir == 1){
+					r = readsState(mod, in.actuals[k], memo);
+				}
+			}
+		}
+		memo[name] = r ? 2 : 1;
+		return r;
+	}
+
+	bvec net(scope &s, const std::string &name){
+		/*
+		 * Value of a net, lowered from its driver the first time it is read.
+		 */
+		if(s.local != NULL && s.local->count(name) != 0){
+			return (*s.local)[name];
+		}
+		std::map<std::string, int>::iterator st = s.state.find(name);
+		if(st != s.state.end() && st->second == 2){
+			return s.value[name];
+		}
+		if(s.mod->nets.count(name) == 0){
+			fail(s, "undeclared net '" + name + "'");
+			return bvec();
+		}
+		if(st != s.state.end()){
+			fail(s, "combinational loop through '" + name + "'");
+			return bvec();
+		}
+		env *saved = s.local;
+		std::map<std::string, std::pair<int,int> >::iterator d = s.mod->drivers.find(name);
+		s.local = NULL;
+		s.state[name] = 1;
+		if(d == s.mod->drivers.end()){
+			s.value[name] = fresh(s, s.mod->nets[name].width);
+		}
+		else if(d->second.first == DRV_ASSIGN){
+			unsigned w = s.mod->nets[name].width;
+			s.value[name] = bv.resize(eval(s, s.mod->assigns[d->second.second].second, w), w, false);
+		}
+		else if(d->second.first == DRV_BLOCK){
+			lowerBlock(s, d->second.second);
+		}
+		else{
+			lowerInstance(s, d->second.second);
+		}
+		s.state[name] = 2;
+		s.local = saved;
+		return s.value[name];
+	}
+
+public:
+	std::string error;
+
+	verilogLowering(bddManager &mgr, std::map<std::string, vlogModule*> &mods, unsigned vars)
+		: m(mgr), bv(mgr), modules(mods), nextVar(0), maxVars(vars){}
+
+	int check(vlogModule *mod){
+		/*
+		 * Lowers mod as the top module and checks its assertions. Returns the number of
+		 * failing or undecided ones, -1 on an error.
+		 */
+		scope s;
+		std::vector<std::string> frees;
+		std::map<std::string, int> memo;
+		std::vector<int> cex;
+		unsigned w = 0, first = nextVar, ante, cons, prop;
+		int failed = 0;
+
+		s.mod = mod;
+		s.local = NULL;
+		s.depth = 0;
+		s.instState.assign(mod->instances.size(), 0);
+		for(unsigned k = 0; k < mod->decls.size(); k++){
+			const std::string &name = mod->decls[k];
+			if(mod->nets[name].dir == 1 || mod->drivers.count(name) == 0){
+				frees.push_back(name);
+				s.value[name].assign(mod->nets[name].width, BDD_FALSE);
+				s.state[name] = 2;
+				w = std::max(w, mod->nets[name].width);
+			}
+		}
+		for(unsigned b = 0; b < w; b++){
+			for(unsigned k = 0; k < frees.size(); k++){
+				if(b < s.value[frees[k]].size() && nextVar < maxVars){
+					s.value[frees[k]][b] = m.ithVar(++nextVar);
+				}
+			}
+		}
+		printf("\nmodule %s: %u free bits", mod->name.c_str(), nextVar - first);
+		for(unsigned k = 0; k < mod->asserts.size(); k++){
+			vlogAssert &a = mod->asserts[k];
+			if(a.ante == NULL){
+				printf("\n  %s: not checked, sequential property (%s)", a.label.c_str(), a.text.c_str());
+				continue;
+			}
+			if(readsState(mod, a.ante, memo) || readsState(mod, a.cons, memo)){
+				/* an invariant of the reachable states, not of every register value */
+				printf("\n  %s: not checked, reads registers (%s)", a.label.c_str(), a.text.c_str());
+				continue;
+			}
+			ante = any(eval(s, a.ante, 0));
+			cons = any(eval(s, a.cons, 0));
+			if(!error.empty()){
+				return -1;
+			}
+			prop = m.Apply(IMPL, ante, cons);
+			if(prop == BDD_TRUE){
+				printf("\n  %s: PASSED", a.label.c_str());
+				continue;
+			}
+			failed++;
+			if(prop == BDD_ABORTED){
+				printf("\n  %s: UNDECIDED (%s)", a.label.c_str(), statusName(m.read_status()));
+				continue;
+			}
+			printf("\n  %s: FAILED", a.label.c_str());
+			if(m.AnySat(m.Not(prop), cex)){
+				/* inputs, and the other free nets the counterexample constrains */
+				for(unsigned j = 0; j < frees.size(); j++){
+					bvec &v = s.value[frees[j]];
+					bool used = (mod->nets[frees[j]].dir == 1);
+					for(unsigned b = 0; b < v.size() && !used; b++){
+						used = (v[b] > BDD_TRUE && cex[m.varAt(m.level(v[b]))] != -1);
+					}
+					if(used){
+						printf(", %s = %llu", frees[j].c_str(), bv.value(v, cex));
+					}
+				}
+			}
+		}
+		return failed;
+	}
+};
+
+int Verilog_check(const char *path, const char *top){
+	/*
+	 * Parses a Verilog file and checks the immediate assertions of every module (or of
+	 * top only), each lowered as the top module into one shared manager. This is what
+	 * running ebmc --bdd with each module as --top did. Returns the number of failing or
+	 * undecided assertions, -1 on a parse or lowering error.
+	 */
+	typedef std::chrono::steady_clock clk;
+	clk::time_point t0 = clk::now();
+	verilogParser p;
+	std::vector<vlogModule*> tops;
+	unsigned vars = 0;
+	int failed = 0, r;
+
+	if(!p.parse(path)){
+		printf("\n%s: %s\n", path, p.error.c_str()); fflush(stdout);
+		return -1;
+	}
+	for(unsigned k = 0; k < p.order.size(); k++){
+		if(top == NULL || p.order[k]->name == top){
+			tops.push_back(p.order[k]);
+			vars += p.freeBits(p.order[k], true);
+		}
+	}
+	if(tops.empty()){
+		printf("\n%s: no module %s\n", path, top); fflush(stdout);
+		return -1;
+	}
+	bddManager m(std::max(vars, 1u));
+	m.setLimits(limitsFromEnv());
+	verilogLowering low(m, p.modules, vars);
+	for(unsigned k = 0; k < tops.size(); k++){
+		if((r = low.check(tops[k])) < 0){
+			printf("\n%s\n", low.error.c_str()); fflush(stdout);
+			return -1;
+		}
+		failed += r;
+	}
+	printf("\n%llu live nodes, %.3fs\n", m.liveNodes(), std::chrono::duration<double>(clk::now() - t0).count());
+	fflush(stdout);
+	return failed;
+}